@@ -14,7 +14,7 @@ public:
     ~CustomDialog();
 
 protected:
-    bool eventFilter(QObject *obj, QEvent *event);
+    bool eventFilter(QObject *obj, QEvent *event) override;
 };
 
 #endif // CUSTOMDIALOG_H
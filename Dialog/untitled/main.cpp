@@ -1,11 +1,19 @@
 #include "mainwindow.h"
+#include "startupprofiler.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // 启动各阶段计时, STARTUP_PROFILE=1 时退出前输出
+    StartupProfiler::start();
     QApplication a(argc, argv);
+    StartupProfiler::applicationCreated();
+
     MainWindow w;
+    StartupProfiler::mark("window constructed");
+    StartupProfiler::markFirstPaint(&w);
     w.show();
+    StartupProfiler::mark("first layout");
     return a.exec();
 }
@@ -1,10 +1,28 @@
 #include "mainwindow.h"
 #include "customdialog.h"
+#include "startupprofiler.h"
 #include <QVBoxLayout>
 #include <QWidget>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+{
+    // 设置窗口属性
+    setMinimumSize(400, 300);
+    setWindowTitle("对话框示例");
+
+    // DIALOG_DEFERRED_STARTUP=1 时先显示窗口外壳, 第一帧之后再创建中央部件
+    if (qEnvironmentVariableIsSet("DIALOG_DEFERRED_STARTUP"))
+        StartupProfiler::afterFirstPaint(this, [this]{ buildCentralWidget(); });
+    else
+        buildCentralWidget();
+}
+
+MainWindow::~MainWindow()
+{
+}
+
+void MainWindow::buildCentralWidget()
 {
     // 创建中央部件
     QWidget *centralWidget = new QWidget(this);
@@ -20,13 +38,7 @@ MainWindow::MainWindow(QWidget *parent)
     // 连接按钮信号到槽
     connect(m_showDialogButton, &QPushButton::clicked, this, &MainWindow::onShowDialogClicked);
 
-    // 设置窗口属性
-    setMinimumSize(400, 300);
-    setWindowTitle("对话框示例");
-}
-
-MainWindow::~MainWindow()
-{
+    StartupProfiler::mark("central widgets built");
 }
 
 void MainWindow::onShowDialogClicked()
@@ -16,6 +16,8 @@ private slots:
     void onShowDialogClicked();
 
 private:
-    QPushButton *m_showDialogButton;
+    void buildCentralWidget();
+
+    QPushButton *m_showDialogButton = nullptr;
 };
 #endif // MAINWINDOW_H
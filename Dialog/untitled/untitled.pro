@@ -8,12 +8,16 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 启动计时工具在仓库根目录的 common/ 中, 与 QTreeView 工程共用
+INCLUDEPATH += ../../common
+
 SOURCES += \
     customdialog.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
+    ../../common/startupprofiler.h \
     customdialog.h \
     mainwindow.h
 
@@ -1,21 +1,67 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 打开性能计数器与浮层: qmake CONFIG+=perf_counters
+perf_counters: DEFINES += LEAFTREE_PERF_COUNTERS
+
+# 与 Dialog 工程共用的启动计时工具
+INCLUDEPATH += ../common
+
 SOURCES += \
+    leafbuttonaccessible.cpp \
     leafbuttondelegate.cpp \
+    leafmove.cpp \
+    leafsortproxymodel.cpp \
+    leaftreemodel.cpp \
+    leafstrip.cpp \
+    livefeedgenerator.cpp \
+    liveupdatequeue.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    memoryreport.cpp \
+    modelprofiler.cpp \
+    pathindex.cpp \
+    perfcounters.cpp \
+    perfoverlay.cpp \
+    rowtilerenderer.cpp \
+    sessionrecorder.cpp \
+    sessionreplayer.cpp \
+    subtreeaggregates.cpp \
+    treeviewstate.cpp
 
 HEADERS += \
+    aligndelegate.h \
+    dynamictreeview.h \
+    leafbuttonaccessible.h \
     leafbuttondelegate.h \
-    mainwindow.h
+    leafmove.h \
+    leafsortproxymodel.h \
+    leaftreemodel.h \
+    leafstrip.h \
+    livefeedgenerator.h \
+    liveupdatequeue.h \
+    mainwindow.h \
+    memoryreport.h \
+    modelprofiler.h \
+    pathindex.h \
+    mpscqueue.h \
+    perfcounters.h \
+    perfoverlay.h \
+    rowtilerenderer.h \
+    sessionrecorder.h \
+    sessionreplayer.h \
+    subtreeaggregates.h \
+    summarydelegate.h \
+    treeroles.h \
+    treeviewstate.h \
+    ../common/startupprofiler.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,32 @@
+#ifndef ALIGNDELEGATE_H
+#define ALIGNDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QApplication>
+#include <QPainter>
+
+class AlignDelegate : public QStyledItemDelegate {
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        QStyleOptionViewItem opt = option;
+        initStyleOption(&opt, index);
+
+        // 绘制复选框
+        QRect checkboxRect = QRect(opt.rect.left() + 2, opt.rect.center().y() - 8, 16, 16);
+        bool checked = (index.data(Qt::CheckStateRole).toInt() == Qt::Checked);
+        QStyle::State state = checked ? QStyle::State_On : QStyle::State_Off;
+        QApplication::style()->drawPrimitive(QStyle::PE_IndicatorItemViewItemCheck, &opt, painter);
+
+        // 调整文本位置
+        QRect textRect = opt.rect.adjusted(24, 0, 0, 0); // 文本向右偏移24px
+        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, index.data().toString());
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        return QSize(200, 24); // 固定项的大小
+    }
+};
+
+#endif // ALIGNDELEGATE_H
@@ -0,0 +1,630 @@
+#ifndef DYNAMICTREEVIEW_H
+#define DYNAMICTREEVIEW_H
+
+#include <QTreeView>
+#include <QApplication>
+#include <QDrag>
+#include <QDragEnterEvent>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QMimeData>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPointer>
+#include <QScreen>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <QWheelEvent>
+#include "leafbuttondelegate.h"
+#include "leafmove.h"
+#include "pathindex.h"
+#include "perfcounters.h"
+#include <cmath>
+
+class DynamicTreeView : public QTreeView {
+public:
+    explicit DynamicTreeView(QWidget *parent = nullptr) : QTreeView(parent) {
+        // 定时器先于样式等设置创建, 这些设置可能同步触发 updateGeometries 和视口事件
+        m_moveTimer = new QTimer(this);
+        m_moveTimer->setSingleShot(true);
+        m_moveTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(m_moveTimer, &QTimer::timeout, this, [this]{ flushPendingMouseMove(); });
+
+        // 0ms 定时器在事件循环处理完已到达的事件后才触发, 预取只占用空闲时间
+        m_prefetchTimer = new QTimer(this);
+        m_prefetchTimer->setSingleShot(true);
+        QObject::connect(m_prefetchTimer, &QTimer::timeout, this, [this]{ runPrefetchSlice(); });
+
+        setStyleSheet("QTreeView { border: none; padding: 0; }");
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+        setMouseTracking(true);  // 启用鼠标追踪
+        viewport()->setMouseTracking(true);  // 视口也需要启用鼠标追踪
+        setAcceptDrops(true);  // 接受叶节点按钮的拖放
+        viewport()->setAcceptDrops(true);
+
+        // 第 0 列占满剩余宽度, 叶节点按钮条在其中水平滚动; 附加列固定宽度, 列宽不随内容变化,
+        // 滚动按钮条时不必测量任何列
+        header()->setStretchLastSection(false);
+        header()->setSectionResizeMode(QHeaderView::Fixed);
+        header()->setDefaultSectionSize(100);
+        QObject::connect(header(), &QHeaderView::sectionCountChanged, this, [this](int, int newCount) {
+            if (newCount > 0)
+                header()->setSectionResizeMode(0, QHeaderView::Stretch);
+        });
+    }
+
+    QSize sizeHint() const override {
+        PERF_SCOPE(Perf::TreeSizeHint);
+
+        // 计算可见行数（包含展开的子项）
+        int visibleRows = calculateVisibleRows(rootIndex());
+        int height = visibleRows * sizeHintForRow(0);
+        height = qMin(height, 200); // 限制最大高度
+        return {width(), height};
+    }
+
+    // 用给定的节点集合替换展开状态: 折叠全部后只剩根节点, 其立即布局很便宜;
+    // 再挂起布局, 这样 expand 只把索引记入展开集合, 之后统一布局一次.
+    // 期间屏蔽 expanded/collapsed 信号, 避免外部连接对每个节点都重新激活布局
+    void setExpandedBulk(const QModelIndexList &indexes) {
+        {
+            const QSignalBlocker blocker(this);
+            collapseAll();
+            scheduleDelayedItemsLayout();
+            for (const QModelIndex &index : indexes)
+                expand(index);
+        }
+        updateGeometry();
+    }
+
+    // 跳转到 "Root > Child > Leaf" 形式的路径: 只展开尚未展开的祖先, 一次布局后滚动到该节点并设为当前项.
+    // 路径索引在首次调用时按当前模型建立, 之后随模型增量维护
+    bool goToPath(const QString &path) {
+        if (!model())
+            return false;
+        if (!m_pathIndex || m_pathIndex->model() != model()) {
+            delete m_pathIndex;
+            m_pathIndex = new PathIndex(model(), this);
+        }
+
+        const QModelIndex target = m_pathIndex->find(path);
+        if (!target.isValid())
+            return false;
+        // 共享模型中被隐藏的行属于另一棵树
+        for (QModelIndex node = target; node.isValid(); node = node.parent()) {
+            if (isRowHidden(node.row(), node.parent()))
+                return false;
+        }
+
+        QModelIndexList ancestors;
+        for (QModelIndex ancestor = target.parent(); ancestor.isValid(); ancestor = ancestor.parent()) {
+            if (!isExpanded(ancestor))
+                ancestors.prepend(ancestor);
+        }
+        if (!ancestors.isEmpty()) {
+            {
+                const QSignalBlocker blocker(this);
+                scheduleDelayedItemsLayout();
+                for (const QModelIndex &ancestor : std::as_const(ancestors))
+                    expand(ancestor);
+            }
+            updateGeometry();
+        }
+
+        setCurrentIndex(target);
+        scrollTo(target, QAbstractItemView::PositionAtCenter);
+        return true;
+    }
+
+    PathIndex *pathIndex() const {
+        return m_pathIndex;
+    }
+
+    // 鼠标移动合并: 没有按键按下的移动每帧最多派发一次, 取最新的位置;
+    // 点击、滚轮、进入/离开等事件派发前先补发挂起的移动, 代理看到的事件顺序不变
+    struct MouseMoveStats {
+        quint64 received = 0;     // 视图收到的鼠标移动
+        quint64 dispatched = 0;   // 派发给 QTreeView 与代理的鼠标移动
+    };
+
+    void setMouseMoveCoalescing(bool enabled) {
+        flushPendingMouseMove();
+        m_coalesceMouseMoves = enabled;
+    }
+
+    bool mouseMoveCoalescing() const {
+        return m_coalesceMouseMoves;
+    }
+
+    MouseMoveStats mouseMoveStats() const {
+        return m_mouseMoveStats;
+    }
+
+    // 立即派发挂起的鼠标移动(没有则什么也不做)
+    void flushPendingMouseMove() {
+        m_moveTimer->stop();
+        if (!m_hasPendingMove)
+            return;
+        m_hasPendingMove = false;
+        QMouseEvent event(QEvent::MouseMove, m_pendingMovePos, viewport()->mapToGlobal(m_pendingMovePos),
+                          Qt::NoButton, Qt::NoButton, m_pendingMoveModifiers);
+        dispatchMouseMove(&event);
+    }
+
+    // 空闲预取: 滚动或布局变化后, 在事件循环空闲时按时间片为视口前后的行预热代理的
+    // 子节点文本与按钮布局, 新滚入的行首次绘制时不必再访问模型. 滚动方向上的预取范围随滚动速度在 1~4 屏之间调整
+    struct PrefetchStats {
+        quint64 warmedRows = 0;   // 实际预热(原先是冷的)的行数
+        quint64 slices = 0;       // 执行的时间片数
+        int windowRows = 0;       // 最近一次排队的预取行数
+    };
+
+    void setIdlePrefetchEnabled(bool enabled) {
+        m_idlePrefetch = enabled;
+        if (!enabled) {
+            m_prefetchTimer->stop();
+            m_prefetchQueue.clear();
+        }
+    }
+
+    bool idlePrefetchEnabled() const {
+        return m_idlePrefetch;
+    }
+
+    PrefetchStats prefetchStats() const {
+        return m_prefetchStats;
+    }
+
+    // 水平滚动 index 所在行的叶节点按钮条 dx 像素, 只重绘这一行; 已到头或该行没有按钮条时返回 false
+    bool scrollLeafStrip(const QModelIndex &index, int dx) {
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        const QModelIndex row = index.sibling(index.row(), 0);
+        if (!leafDelegate || !row.isValid() || !leafDelegate->scrollStrip(row, dx))
+            return false;
+        viewport()->update(visualRect(row));
+        return true;
+    }
+
+    // 正在从本视图拖出的叶节点; 放下的视图经 QDropEvent::source() 取得, 不经过 MIME 数据
+    QModelIndexList draggedLeafs() const {
+        QModelIndexList leafs;
+        for (const QPersistentModelIndex &leaf : m_draggedLeafs) {
+            if (leaf.isValid())
+                leafs.append(leaf);
+        }
+        return leafs;
+    }
+
+private:
+    bool m_tilePrefetchScheduled = false;
+    QPointer<PathIndex> m_pathIndex;
+
+    // 拖放状态: 按下的叶节点按钮、拖动中的叶节点和放下位置的标记
+    QPersistentModelIndex m_pressedLeaf;
+    QPoint m_pressPos;
+    QList<QPersistentModelIndex> m_draggedLeafs;
+    QRect m_dropMarker;
+
+    // 鼠标移动合并状态
+    bool m_coalesceMouseMoves = true;
+    bool m_hasPendingMove = false;
+    QPoint m_pendingMovePos;
+    Qt::KeyboardModifiers m_pendingMoveModifiers;
+    QElapsedTimer m_lastMoveDispatch;
+    QTimer *m_moveTimer = nullptr;
+    MouseMoveStats m_mouseMoveStats;
+
+    // 空闲预取状态; 队列中用持久索引, 时间片之间模型可能变化
+    static constexpr qint64 PrefetchSliceNs = 2000000;   // 每个时间片最多 2ms, 之后让出事件循环
+    bool m_idlePrefetch = true;
+    bool m_prefetchRebuild = false;
+    QTimer *m_prefetchTimer = nullptr;
+    QList<QPersistentModelIndex> m_prefetchQueue;
+    QElapsedTimer m_lastScroll;
+    double m_scrollVelocity = 0.0;   // 像素/毫秒, 指数平滑
+    bool m_scrollingDown = true;
+    PrefetchStats m_prefetchStats;
+
+    void scheduleIdlePrefetch() {
+        if (!m_idlePrefetch)
+            return;
+        // 队列在第一个时间片中按届时的位置重建, 不占用滚动本身的时间
+        m_prefetchRebuild = true;
+        if (!m_prefetchTimer->isActive())
+            m_prefetchTimer->start(0);
+    }
+
+    void noteScroll(int dy) {
+        // 与上次滚动间隔超过半秒视为重新开始滚动
+        const qint64 elapsed = m_lastScroll.isValid() ? m_lastScroll.restart() : -1;
+        if (elapsed < 0)
+            m_lastScroll.start();
+        if (elapsed < 0 || elapsed > 500)
+            m_scrollVelocity = 0.0;
+        else
+            m_scrollVelocity = 0.5 * m_scrollVelocity + 0.5 * qAbs(dy) / double(qMax<qint64>(1, elapsed));
+        m_scrollingDown = dy < 0;
+        scheduleIdlePrefetch();
+    }
+
+    void buildPrefetchQueue() {
+        m_prefetchQueue.clear();
+        const QModelIndex top = indexAt(QPoint(1, 1));
+        if (!top.isValid())
+            return;
+
+        const int rowHeight = qMax(1, visualRect(top).height());
+        const int pageRows = viewport()->height() / rowHeight + 1;
+
+        // 滚动方向上覆盖按当前速度约 250ms 的滚动距离, 反方向只取一屏
+        const bool scrolling = m_lastScroll.isValid() && m_lastScroll.elapsed() <= 500;
+        const double screensPerSecond = scrolling ? m_scrollVelocity * 1000.0 / qMax(1, viewport()->height()) : 0.0;
+        const int aheadRows = pageRows * qBound(1, int(std::ceil(screensPerSecond * 0.25)), 4);
+        const int belowRows = m_scrollingDown ? aheadRows : pageRows;
+        const int aboveRows = m_scrollingDown ? pageRows : aheadRows;
+
+        // 先排运动方向上离视口最近的行
+        QList<QPersistentModelIndex> below;
+        QModelIndex index = top;
+        for (int i = 0; i < pageRows + belowRows && index.isValid(); ++i, index = indexBelow(index)) {
+            if (i >= pageRows)
+                below.append(index);
+        }
+        QList<QPersistentModelIndex> above;
+        index = indexAbove(top);
+        for (int i = 0; i < aboveRows && index.isValid(); ++i, index = indexAbove(index))
+            above.append(index);
+
+        m_prefetchQueue = m_scrollingDown ? below + above : above + below;
+        m_prefetchStats.windowRows = m_prefetchQueue.size();
+    }
+
+    void runPrefetchSlice() {
+        PERF_SCOPE(Perf::IdlePrefetch);
+
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        if (!m_idlePrefetch || !leafDelegate || !model()) {
+            m_prefetchQueue.clear();
+            return;
+        }
+        if (m_prefetchRebuild) {
+            m_prefetchRebuild = false;
+            buildPrefetchQueue();
+        }
+
+        ++m_prefetchStats.slices;
+        QElapsedTimer slice;
+        slice.start();
+        const QStyleOptionViewItem option = rowOption();
+        while (!m_prefetchQueue.isEmpty() && slice.nsecsElapsed() < PrefetchSliceNs) {
+            const QModelIndex index = m_prefetchQueue.takeFirst();
+            if (!index.isValid())
+                continue;
+            QStyleOptionViewItem rowStyle = option;
+            rowStyle.rect = visualRect(index);
+            if (leafDelegate->warmRow(rowStyle, index))
+                ++m_prefetchStats.warmedRows;
+        }
+
+        // 还有剩余时让出事件循环, 先处理到达的输入再继续下一片
+        if (!m_prefetchQueue.isEmpty())
+            m_prefetchTimer->start(0);
+    }
+
+    // 按屏幕刷新率计算一帧的时长
+    static qint64 frameIntervalMs() {
+        const QScreen *screen = QGuiApplication::primaryScreen();
+        const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+        return qMax<qint64>(1, qRound64(1000.0 / refreshRate));
+    }
+
+    void dispatchMouseMove(QMouseEvent *event) {
+        ++m_mouseMoveStats.dispatched;
+        PERF_COUNT(Perf::MouseMoveDispatched);
+        m_lastMoveDispatch.start();
+        QTreeView::mouseMoveEvent(event);
+    }
+
+    // QMouseEvent::pos() 和 QDropEvent::pos() 在 Qt 6 中已弃用
+    static QPoint eventPos(const QMouseEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        return event->position().toPoint();
+#else
+        return event->pos();
+#endif
+    }
+
+    // QWheelEvent::pos() 自 Qt 5.14 起由 position() 取代
+    static QPoint eventPos(const QWheelEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        return event->position().toPoint();
+#else
+        return event->pos();
+#endif
+    }
+
+    static QPoint eventPos(const QDropEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        return event->position().toPoint();
+#else
+        return event->pos();
+#endif
+    }
+
+    void startLeafDrag() {
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        const QModelIndex pressed = m_pressedLeaf;
+        m_pressedLeaf = QPersistentModelIndex();
+        if (!leafDelegate || !pressed.isValid())
+            return;
+
+        m_draggedLeafs.clear();
+        const QModelIndexList leafs = leafDelegate->dragLeafs(pressed);
+        for (const QModelIndex &leaf : leafs)
+            m_draggedLeafs.append(leaf);
+
+        // 只放格式标记, 节点本身由放下的视图按持久索引直接移动
+        QMimeData *mimeData = new QMimeData;
+        mimeData->setData(LeafMove::mimeType(), QByteArray());
+        QDrag *drag = new QDrag(this);
+        drag->setMimeData(mimeData);
+        drag->exec(Qt::MoveAction);
+        m_draggedLeafs.clear();
+    }
+
+    static const DynamicTreeView *leafDragSource(const QDropEvent *event) {
+        if (!event->mimeData()->hasFormat(LeafMove::mimeType()))
+            return nullptr;
+        const DynamicTreeView *source = dynamic_cast<const DynamicTreeView *>(event->source());
+        return source && !source->m_draggedLeafs.isEmpty() ? source : nullptr;
+    }
+
+    // 放下位置所在的子节点行及插入行号, 不是子节点行时返回无效索引
+    QModelIndex leafDropTarget(const QPoint &pos, int *row) const {
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        const QModelIndex index = indexAt(pos);
+        *row = leafDelegate && index.isValid() ? leafDelegate->dropRow(index, pos) : -1;
+        return *row >= 0 ? index : QModelIndex();
+    }
+
+    void setDropMarker(const QRect &rect) {
+        if (rect == m_dropMarker)
+            return;
+        viewport()->update(m_dropMarker);
+        m_dropMarker = rect;
+        viewport()->update(m_dropMarker);
+    }
+
+    QStyleOptionViewItem rowOption() const {
+        QStyleOptionViewItem option;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        initViewItemOption(&option);
+#else
+        option = viewOptions();
+#endif
+        return option;
+    }
+
+    void prefetchRowTile(LeafButtonDelegate *leafDelegate, QStyleOptionViewItem option, const QModelIndex &index) {
+        option.rect = visualRect(index);
+        if (selectionModel() && selectionModel()->isSelected(index))
+            option.state |= QStyle::State_Selected;
+        leafDelegate->prefetchTile(option, index, viewport()->devicePixelRatioF());
+    }
+
+    // 滚动后为下一屏和上一屏的行请求图块, 当前屏的行已由绘制同步渲染
+    void prefetchTiles() {
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        const QModelIndex top = indexAt(QPoint(1, 1));
+        if (!leafDelegate || !leafDelegate->tileRenderer() || !top.isValid())
+            return;
+
+        const int rowHeight = qMax(1, visualRect(top).height());
+        const int pageRows = viewport()->height() / rowHeight + 1;
+        const QStyleOptionViewItem option = rowOption();
+
+        // 向下: 当前屏之后再多取一屏, 多数滚动是向下的
+        QModelIndex index = top;
+        for (int i = 0; i < pageRows * 2 && index.isValid(); ++i, index = indexBelow(index)) {
+            if (i >= pageRows)
+                prefetchRowTile(leafDelegate, option, index);
+        }
+        index = indexAbove(top);
+        for (int i = 0; i < pageRows && index.isValid(); ++i, index = indexAbove(index))
+            prefetchRowTile(leafDelegate, option, index);
+    }
+
+    int calculateVisibleRows(const QModelIndex &parent) const {
+        int count = 0;
+        const int rowCount = model()->rowCount(parent);
+        for (int i = 0; i < rowCount; ++i) {
+            if (isRowHidden(i, parent)) // 隐藏的行(共享模型中属于另一棵树)不占高度
+                continue;
+            const QModelIndex index = model()->index(i, 0, parent);
+            ++count; // 当前行
+            if (isExpanded(index)) { // 递归计算展开的子项
+                count += calculateVisibleRows(index);
+            }
+        }
+        return count;
+    }
+
+protected:
+    void updateGeometries() override {
+        QTreeView::updateGeometries();
+        // 展开、折叠、尺寸变化后视口附近的行可能变了
+        scheduleIdlePrefetch();
+    }
+
+    void scrollContentsBy(int dx, int dy) override {
+        QTreeView::scrollContentsBy(dx, dy);
+        if (dy != 0)
+            noteScroll(dy);
+
+        // 图块模式下, 等本次滚动的绘制完成后再预取附近的行, 同一轮事件中的多次滚动只预取一次
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        if (dy != 0 && leafDelegate && leafDelegate->tileRenderer() && !m_tilePrefetchScheduled) {
+            m_tilePrefetchScheduled = true;
+            QTimer::singleShot(0, this, [this]{
+                m_tilePrefetchScheduled = false;
+                prefetchTiles();
+            });
+        }
+    }
+
+    void wheelEvent(QWheelEvent *event) override {
+        // 水平滚轮(或 Shift+垂直滚轮)滚动光标下那一行的按钮条; 按钮条到头后交给树做普通的水平滚动.
+        // 滚轮一格(120)移动一个按钮, 触控板给出像素增量时直接使用
+        QPoint delta = event->pixelDelta();
+        if (delta.isNull())
+            delta = event->angleDelta() * LeafStrip::ButtonPitch / 120;
+        const int dx = delta.x() != 0 || !event->modifiers().testFlag(Qt::ShiftModifier) ? delta.x() : delta.y();
+        if (dx != 0 && scrollLeafStrip(indexAt(eventPos(event)), -dx)) {
+            event->accept();
+            return;
+        }
+        QTreeView::wheelEvent(event);
+    }
+
+    void keyPressEvent(QKeyEvent *event) override {
+        // 叶节点按钮的键盘导航优先于树的默认按键处理
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        if (leafDelegate && leafDelegate->handleKeyPress(event, this)) {
+            event->accept();
+            return;
+        }
+        QTreeView::keyPressEvent(event);
+    }
+
+    void mousePressEvent(QMouseEvent *event) override {
+        // 记下按下的叶节点按钮, 移动超过拖动距离后开始拖放
+        m_pressedLeaf = QPersistentModelIndex();
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        if (leafDelegate && event->button() == Qt::LeftButton) {
+            m_pressPos = eventPos(event);
+            m_pressedLeaf = leafDelegate->leafAt(indexAt(m_pressPos), m_pressPos);
+        }
+        QTreeView::mousePressEvent(event);
+    }
+
+    void mouseMoveEvent(QMouseEvent *event) override {
+        ++m_mouseMoveStats.received;
+        PERF_COUNT(Perf::MouseMoveReceived);
+
+        if (m_pressedLeaf.isValid() && event->buttons().testFlag(Qt::LeftButton)
+                && (eventPos(event) - m_pressPos).manhattanLength() >= QApplication::startDragDistance()) {
+            flushPendingMouseMove();
+            startLeafDrag();
+            return;
+        }
+
+        // 按键按下时(拖动、框选)逐个派发, 之前挂起的移动先补发
+        if (!m_coalesceMouseMoves || event->buttons() != Qt::NoButton) {
+            flushPendingMouseMove();
+            dispatchMouseMove(event);
+            return;
+        }
+
+        m_pendingMovePos = eventPos(event);
+        m_pendingMoveModifiers = event->modifiers();
+        m_hasPendingMove = true;
+
+        // 这一帧还没有派发过就立即派发, 否则到下一帧开始时派发最新的位置
+        const qint64 frameMs = frameIntervalMs();
+        const qint64 sinceLast = m_lastMoveDispatch.isValid() ? m_lastMoveDispatch.elapsed() : frameMs;
+        if (sinceLast >= frameMs)
+            flushPendingMouseMove();
+        else if (!m_moveTimer->isActive())
+            m_moveTimer->start(int(frameMs - sinceLast));
+    }
+
+    bool viewportEvent(QEvent *event) override {
+        switch (event->type()) {
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::Wheel:
+        case QEvent::Enter:
+        case QEvent::Leave:
+        case QEvent::ContextMenu:
+        case QEvent::ToolTip:
+        case QEvent::DragEnter:
+            flushPendingMouseMove();
+            break;
+        default:
+            break;
+        }
+        return QTreeView::viewportEvent(event);
+    }
+
+    void mouseReleaseEvent(QMouseEvent *event) override {
+        m_pressedLeaf = QPersistentModelIndex();
+        QTreeView::mouseReleaseEvent(event);
+    }
+
+    // 叶节点拖放自行处理, 其他拖放交给 QTreeView
+    void dragEnterEvent(QDragEnterEvent *event) override {
+        if (!event->mimeData()->hasFormat(LeafMove::mimeType())) {
+            QTreeView::dragEnterEvent(event);
+            return;
+        }
+        if (leafDragSource(event))
+            event->acceptProposedAction();
+        else
+            event->ignore();
+    }
+
+    void dragMoveEvent(QDragMoveEvent *event) override {
+        if (!event->mimeData()->hasFormat(LeafMove::mimeType())) {
+            QTreeView::dragMoveEvent(event);
+            return;
+        }
+        LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate());
+        int row = -1;
+        const QModelIndex parent = leafDropTarget(eventPos(event), &row);
+        if (parent.isValid() && leafDragSource(event)) {
+            setDropMarker(leafDelegate->dropMarkerRect(parent, row));
+            event->acceptProposedAction();
+        } else {
+            setDropMarker(QRect());
+            event->ignore();
+        }
+    }
+
+    void dragLeaveEvent(QDragLeaveEvent *event) override {
+        setDropMarker(QRect());
+        QTreeView::dragLeaveEvent(event);
+    }
+
+    void dropEvent(QDropEvent *event) override {
+        if (!event->mimeData()->hasFormat(LeafMove::mimeType())) {
+            QTreeView::dropEvent(event);
+            return;
+        }
+        setDropMarker(QRect());
+
+        const DynamicTreeView *source = leafDragSource(event);
+        int row = -1;
+        const QModelIndex parent = leafDropTarget(eventPos(event), &row);
+        if (!source || !parent.isValid() || LeafMove::moveLeafs(source->draggedLeafs(), parent, row) < 0) {
+            event->ignore();
+            return;
+        }
+        event->acceptProposedAction();
+        if (LeafButtonDelegate *leafDelegate = qobject_cast<LeafButtonDelegate *>(itemDelegate()))
+            leafDelegate->clearLeafSelection();
+    }
+
+    void paintEvent(QPaintEvent *event) override {
+        PERF_FRAME(); // 视口的一次绘制记为一帧
+        QTreeView::paintEvent(event);
+
+        if (!m_dropMarker.isEmpty()) {
+            QPainter painter(viewport());
+            painter.fillRect(m_dropMarker, palette().highlight());
+        }
+    }
+};
+
+#endif // DYNAMICTREEVIEW_H
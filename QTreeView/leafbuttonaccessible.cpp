@@ -0,0 +1,151 @@
+#include "leafbuttonaccessible.h"
+#include "leafbuttondelegate.h"
+#include <QAbstractItemView>
+
+#ifndef QT_NO_ACCESSIBILITY
+
+LeafButtonAccessible::LeafButtonAccessible(QAbstractItemView *view, LeafButtonDelegate *delegate,
+                                           const QModelIndex &parentIndex, int slot)
+    : m_view(view)
+    , m_delegate(delegate)
+    , m_parentIndex(parentIndex)
+    , m_slot(slot)
+{
+}
+
+bool LeafButtonAccessible::isValid() const
+{
+    return m_view && m_delegate && m_parentIndex.isValid()
+            && m_slot >= 0 && m_slot < m_delegate->leafButtonCount(m_parentIndex);
+}
+
+QObject *LeafButtonAccessible::object() const
+{
+    // 与 Qt 的表格单元格接口一样, 虚拟元素没有对应的 QObject
+    return nullptr;
+}
+
+QAccessibleInterface *LeafButtonAccessible::childAt(int x, int y) const
+{
+    Q_UNUSED(x);
+    Q_UNUSED(y);
+    return nullptr;
+}
+
+QAccessibleInterface *LeafButtonAccessible::parent() const
+{
+    return m_view ? QAccessible::queryAccessibleInterface(m_view.data()) : nullptr;
+}
+
+QAccessibleInterface *LeafButtonAccessible::child(int index) const
+{
+    Q_UNUSED(index);
+    return nullptr;
+}
+
+int LeafButtonAccessible::childCount() const
+{
+    return 0;
+}
+
+int LeafButtonAccessible::indexOfChild(const QAccessibleInterface *child) const
+{
+    Q_UNUSED(child);
+    return -1;
+}
+
+QString LeafButtonAccessible::text(QAccessible::Text t) const
+{
+    if (!isValid())
+        return QString();
+
+    switch (t) {
+    case QAccessible::Name:
+        return m_delegate->leafButtonText(m_parentIndex, m_slot);
+    case QAccessible::Description:
+        return QString("%1 of %2 in %3")
+                .arg(m_slot + 1)
+                .arg(m_delegate->leafButtonCount(m_parentIndex))
+                .arg(m_parentIndex.data().toString());
+    case QAccessible::Help:
+        return QString("Enter to open, Delete to remove, Left/Right to move");
+    default:
+        break;
+    }
+    return QString();
+}
+
+void LeafButtonAccessible::setText(QAccessible::Text t, const QString &text)
+{
+    Q_UNUSED(t);
+    Q_UNUSED(text);
+}
+
+QRect LeafButtonAccessible::rect() const
+{
+    if (!isValid())
+        return QRect();
+
+    // 按钮矩形保存在视口坐标中, 无障碍接口需要屏幕坐标
+    const QRect local = m_delegate->leafButtonRect(m_parentIndex, m_slot);
+    return QRect(m_view->viewport()->mapToGlobal(local.topLeft()), local.size());
+}
+
+QAccessible::Role LeafButtonAccessible::role() const
+{
+    return QAccessible::Button;
+}
+
+QAccessible::State LeafButtonAccessible::state() const
+{
+    QAccessible::State s;
+    s.focusable = true;
+    if (!isValid()) {
+        s.invalid = true;
+        return s;
+    }
+    s.focused = m_delegate->hasLeafFocus(m_parentIndex, m_slot);
+    return s;
+}
+
+void *LeafButtonAccessible::interface_cast(QAccessible::InterfaceType type)
+{
+    if (type == QAccessible::ActionInterface)
+        return static_cast<QAccessibleActionInterface *>(this);
+    return nullptr;
+}
+
+QStringList LeafButtonAccessible::actionNames() const
+{
+    if (!isValid())
+        return QStringList();
+    if (m_delegate->isMoreButton(m_parentIndex, m_slot) || m_delegate->isCollapseButton(m_parentIndex, m_slot))
+        return QStringList() << pressAction();
+    return QStringList() << pressAction() << deleteAction();
+}
+
+void LeafButtonAccessible::doAction(const QString &actionName)
+{
+    if (!isValid())
+        return;
+    if (actionName == pressAction())
+        m_delegate->activateLeafButton(m_parentIndex, m_slot, m_view);
+    else if (actionName == deleteAction())
+        m_delegate->deleteLeafButton(m_parentIndex, m_slot);
+}
+
+QStringList LeafButtonAccessible::keyBindingsForAction(const QString &actionName) const
+{
+    if (actionName == pressAction())
+        return QStringList() << "Return";
+    if (actionName == deleteAction())
+        return QStringList() << "Delete";
+    return QStringList();
+}
+
+QString LeafButtonAccessible::deleteAction()
+{
+    return QStringLiteral("Delete");
+}
+
+#endif // QT_NO_ACCESSIBILITY
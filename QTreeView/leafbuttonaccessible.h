@@ -0,0 +1,50 @@
+#ifndef LEAFBUTTONACCESSIBLE_H
+#define LEAFBUTTONACCESSIBLE_H
+
+#include <QAccessible>
+#include <QPersistentModelIndex>
+#include <QPointer>
+
+class QAbstractItemView;
+class LeafButtonDelegate;
+
+#ifndef QT_NO_ACCESSIBILITY
+
+// 叶节点按钮的虚拟无障碍接口: 按钮只是代理绘制出来的矩形, 不创建真实控件
+// 只为当前键盘焦点所在的按钮创建一个实例, 随焦点移动替换
+class LeafButtonAccessible : public QAccessibleInterface, public QAccessibleActionInterface
+{
+public:
+    LeafButtonAccessible(QAbstractItemView *view, LeafButtonDelegate *delegate,
+                         const QModelIndex &parentIndex, int slot);
+
+    bool isValid() const override;
+    QObject *object() const override;
+    QAccessibleInterface *childAt(int x, int y) const override;
+    QAccessibleInterface *parent() const override;
+    QAccessibleInterface *child(int index) const override;
+    int childCount() const override;
+    int indexOfChild(const QAccessibleInterface *child) const override;
+    QString text(QAccessible::Text t) const override;
+    void setText(QAccessible::Text t, const QString &text) override;
+    QRect rect() const override;
+    QAccessible::Role role() const override;
+    QAccessible::State state() const override;
+    void *interface_cast(QAccessible::InterfaceType type) override;
+
+    QStringList actionNames() const override;
+    void doAction(const QString &actionName) override;
+    QStringList keyBindingsForAction(const QString &actionName) const override;
+
+    static QString deleteAction();
+
+private:
+    QPointer<QAbstractItemView> m_view;
+    QPointer<LeafButtonDelegate> m_delegate;
+    QPersistentModelIndex m_parentIndex;
+    int m_slot;
+};
+
+#endif // QT_NO_ACCESSIBILITY
+
+#endif // LEAFBUTTONACCESSIBLE_H
@@ -1,30 +1,132 @@
 #include "leafbuttondelegate.h"
+#include "leafbuttonaccessible.h"
+#include "leafstrip.h"
+#include "pathindex.h"
+#include "perfcounters.h"
+#include "rowtilerenderer.h"
+#include "subtreeaggregates.h"
+#include "treeroles.h"
+#include <QHelpEvent>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QKeyEvent>
+#include <QTreeView>
 #include <QMessageBox>
 #include <QDialog>
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
 #include <QApplication>
-#include <QListWidget>
+#include <QListView>
+#include <QToolTip>
+
+namespace {
+
+// QMouseEvent::pos() 在 Qt 6 中已弃用
+QPoint eventPos(const QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+// 图块缓存键: 行标识 + 尺寸 + 选中状态 + 设备像素比
+RowTileRenderer::TileKey tileKey(const QStyleOptionViewItem &option, const QModelIndex &index, qreal devicePixelRatio)
+{
+    RowTileRenderer::TileKey key;
+    key.model = index.model();
+    key.internalId = index.internalId();
+    key.row = index.row();
+    key.column = index.column();
+    key.size = option.rect.size();
+    key.selected = option.state.testFlag(QStyle::State_Selected);
+    key.devicePixelRatio = devicePixelRatio;
+    return key;
+}
+
+} // namespace
 
 LeafButtonDelegate::LeafButtonDelegate(QObject *parent)
     : QStyledItemDelegate(parent)
 {
 }
 
+void LeafButtonDelegate::setLeafPageSize(int pageSize)
+{
+    m_leafPageSize = qMax(1, pageSize);
+}
+
+int LeafButtonDelegate::leafPageSize() const
+{
+    return m_leafPageSize;
+}
+
+int LeafButtonDelegate::revealedLeafCount(const QModelIndex &parentIndex) const
+{
+    return m_revealedLeafs.value(QPersistentModelIndex(parentIndex), LeafStrip::MaxVisibleLeafs);
+}
+
+QModelIndexList LeafButtonDelegate::pagedParents(const QAbstractItemModel *model) const
+{
+    QModelIndexList parents;
+    for (auto it = m_revealedLeafs.constBegin(); it != m_revealedLeafs.constEnd(); ++it) {
+        if (it.key().isValid() && it.key().model() == model)
+            parents.append(it.key());
+    }
+    return parents;
+}
+
+void LeafButtonDelegate::setRevealedLeafCounts(const QAbstractItemModel *model,
+                                               const QVector<QPair<QModelIndex, int>> &counts)
+{
+    for (auto it = m_revealedLeafs.begin(); it != m_revealedLeafs.end();) {
+        if (!it.key().isValid() || it.key().model() == model)
+            it = m_revealedLeafs.erase(it);
+        else
+            ++it;
+    }
+    for (const auto &count : counts) {
+        if (count.first.isValid() && count.second > LeafStrip::MaxVisibleLeafs)
+            m_revealedLeafs.insert(QPersistentModelIndex(count.first), count.second);
+    }
+    if (m_tileRenderer)
+        m_tileRenderer->invalidate();
+}
+
+void LeafButtonDelegate::setTileRenderer(RowTileRenderer *renderer)
+{
+    m_tileRenderer = renderer;
+}
+
+RowTileRenderer *LeafButtonDelegate::tileRenderer() const
+{
+    return m_tileRenderer;
+}
+
 LeafButtonDelegate::~LeafButtonDelegate()
 {
+#ifndef QT_NO_ACCESSIBILITY
+    if (m_accessibleFocusId)
+        QAccessible::deleteAccessibleInterface(m_accessibleFocusId);
+#endif
 }
 
 void LeafButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
+    PERF_SCOPE(Perf::DelegatePaint);
+
+    if (m_tileRenderer) {
+        paintTile(painter, option, index);
+        return;
+    }
+
     QStyledItemDelegate::paint(painter, option, index);
 
     if (isChildNode(index)) {
         // 如果这是一个子节点，将其叶节点绘制为按钮
-        updateLeafLayouts(painter, option, index);
+        updateLeafLayouts(painter->fontMetrics(), option, index);
         paintLeafButtons(painter, option, index);
     }
 }
@@ -32,17 +134,20 @@ void LeafButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &op
 bool LeafButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
 {
     if (isChildNode(index)) {
+        // 滚出可见区域的按钮可能仍有一部分矩形落在行文本上, 命中测试只在按钮条可见区域内进行
+        const QRect stripClip = m_stripLayouts.value(QPersistentModelIndex(index)).clip;
+
         switch (event->type()) {
         case QEvent::MouseMove: {
             QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-            QPoint pos = mouseEvent->pos();
+            QPoint pos = eventPos(mouseEvent);
 
             QPersistentModelIndex oldHoverIndex = m_hoverIndex;
             m_hoverIndex = QPersistentModelIndex(); // 重置悬停索引
 
             // 检查是否悬停在任何叶节点上
             auto &leafMap = m_leafButtonsInfo[QPersistentModelIndex(index)];
-            for (auto it = leafMap.begin(); it != leafMap.end(); ++it) {
+            for (auto it = leafMap.begin(); it != leafMap.end() && stripClip.contains(pos); ++it) {
                 if (it.value().leafRect.contains(pos)) {
                     m_hoverIndex = it.key();
                     break;
@@ -70,14 +175,28 @@ bool LeafButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, c
         }
         case QEvent::MouseButtonRelease: {
             QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
-            QPoint pos = mouseEvent->pos();
+            QPoint pos = eventPos(mouseEvent);
+            if (!stripClip.contains(pos))
+                break;
 
             // 检查是否点击了"..."按钮
             auto moreIt = m_moreButtonsInfo.find(QPersistentModelIndex(index));
+            if (moreIt != m_moreButtonsInfo.end() && moreIt.value().leafRect.contains(pos)
+                    && mouseEvent->button() == Qt::RightButton) {
+                // 右键"..."按钮: 在独立的列表中浏览全部叶节点
+                showAllLeafNodes(index);
+                return true;
+            }
             if (moreIt != m_moreButtonsInfo.end() && moreIt.value().leafRect.contains(pos)) {
-                // 点击了"..."按钮，展开显示所有叶节点
-                m_expandedNodes.insert(QPersistentModelIndex(index));
-                emit const_cast<LeafButtonDelegate*>(this)->sizeHintChanged(index);
+                // 点击了"..."按钮，再显示一页叶节点
+                revealNextPage(index);
+                return true;
+            }
+
+            // 检查是否点击了收起按钮
+            auto collapseIt = m_collapseButtonsInfo.find(QPersistentModelIndex(index));
+            if (collapseIt != m_collapseButtonsInfo.end() && collapseIt.value().leafRect.contains(pos)) {
+                collapseLeafs(index);
                 return true;
             }
 
@@ -89,7 +208,13 @@ bool LeafButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, c
                     emit leafDeleted(it.key());
                     return true;
                 } else if (it.value().leafRect.contains(pos) && !it.value().deleteButtonRect.contains(pos)) {
+                    // Ctrl+点击只切换选中, 供多选拖动
+                    if (mouseEvent->modifiers().testFlag(Qt::ControlModifier)) {
+                        toggleLeafSelection(it.key());
+                        return true;
+                    }
                     // 点击了叶节点按钮(但不在X上)
+                    clearLeafSelection();
                     emit leafClicked(it.key());
                     showLeafDetailsDialog(it.key());
                     return true;
@@ -107,6 +232,8 @@ bool LeafButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, c
 
 QSize LeafButtonDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
+    PERF_SCOPE(Perf::DelegateSizeHint);
+
     QSize size = QStyledItemDelegate::sizeHint(option, index);
 
     if (isChildNode(index)) {
@@ -117,6 +244,320 @@ QSize LeafButtonDelegate::sizeHint(const QStyleOptionViewItem &option, const QMo
     return size;
 }
 
+bool LeafButtonDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                                   const QModelIndex &index)
+{
+    if (!event || event->type() != QEvent::ToolTip || !index.isValid() || index.data(Qt::ToolTipRole).isValid())
+        return QStyledItemDelegate::helpEvent(event, view, option, index);
+
+    const QModelIndex leaf = leafAt(index, event->pos());
+    const QModelIndex node = leaf.isValid() ? leaf : index;
+    QToolTip::showText(event->globalPos(),
+                       QString("%1\n%2").arg(PathIndex::pathFor(node), SubtreeAggregates::describe(SubtreeAggregates::summaryFor(node))),
+                       view);
+    return true;
+}
+
+bool LeafButtonDelegate::handleKeyPress(QKeyEvent *event, QAbstractItemView *view)
+{
+    const QModelIndex current = view->currentIndex();
+    const bool focused = m_focusParent.isValid() && m_focusParent == current && m_focusSlot >= 0;
+
+    const bool hasModifiers = event->modifiers() != Qt::NoModifier && event->modifiers() != Qt::KeypadModifier;
+    if (!isChildNode(current) || hasModifiers) {
+        if (focused)
+            setLeafFocus(QModelIndex(), -1, view);
+        return false;
+    }
+
+    const int count = leafButtonCount(current);
+    if (count == 0)
+        return false;
+    const int slot = focused ? qMin(m_focusSlot, count - 1) : -1;
+
+    switch (event->key()) {
+    case Qt::Key_Right: {
+        if (focused) {
+            setLeafFocus(current, qMin(slot + 1, count - 1), view);
+            return true;
+        }
+        // 行折叠时保留树的默认行为(展开), 否则进入叶节点按钮
+        QTreeView *tree = qobject_cast<QTreeView *>(view);
+        if (tree && !tree->isExpanded(current))
+            return false;
+        setLeafFocus(current, 0, view);
+        return true;
+    }
+    case Qt::Key_Left:
+        if (!focused)
+            return false;
+        setLeafFocus(current, slot - 1, view); // 第一个按钮再向左则离开按钮
+        return true;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (!focused)
+            return false;
+        activateLeafButton(current, slot, view);
+        return true;
+    case Qt::Key_Delete:
+        if (!focused)
+            return false;
+        deleteLeafButton(current, slot);
+        return true;
+    case Qt::Key_Escape:
+        if (!focused)
+            return false;
+        setLeafFocus(QModelIndex(), -1, view);
+        return true;
+    default:
+        // 其他按键(上下移动等)交给树处理, 同时清除按钮焦点
+        if (focused)
+            setLeafFocus(QModelIndex(), -1, view);
+        return false;
+    }
+}
+
+int LeafButtonDelegate::leafButtonCount(const QModelIndex &parentIndex) const
+{
+    // 包括滚出可见区域的按钮; 槽位几何由按钮条布局直接算出
+    return m_stripLayouts.value(QPersistentModelIndex(parentIndex)).slotCount();
+}
+
+QRect LeafButtonDelegate::leafButtonRect(const QModelIndex &parentIndex, int slot) const
+{
+    return m_stripLayouts.value(QPersistentModelIndex(parentIndex)).slotRect(slot);
+}
+
+QString LeafButtonDelegate::leafButtonText(const QModelIndex &parentIndex, int slot) const
+{
+    if (isMoreButton(parentIndex, slot))
+        return QString("Show more leaves");
+    if (isCollapseButton(parentIndex, slot))
+        return QString("Show fewer leaves");
+    return leafAtSlot(parentIndex, slot).data().toString();
+}
+
+bool LeafButtonDelegate::isMoreButton(const QModelIndex &parentIndex, int slot) const
+{
+    const LeafStrip::StripLayout strip = m_stripLayouts.value(QPersistentModelIndex(parentIndex));
+    return strip.hasMore && slot == strip.leafCount;
+}
+
+bool LeafButtonDelegate::isCollapseButton(const QModelIndex &parentIndex, int slot) const
+{
+    // 收起按钮排在"..."按钮之后
+    const LeafStrip::StripLayout strip = m_stripLayouts.value(QPersistentModelIndex(parentIndex));
+    return strip.hasCollapse && slot == strip.slotCount() - 1;
+}
+
+bool LeafButtonDelegate::hasLeafFocus(const QModelIndex &parentIndex, int slot) const
+{
+    return m_focusSlot == slot && m_focusParent.isValid() && m_focusParent == parentIndex;
+}
+
+void LeafButtonDelegate::activateLeafButton(const QModelIndex &parentIndex, int slot, QAbstractItemView *view)
+{
+    if (isMoreButton(parentIndex, slot)) {
+        // 与点击"..."相同: 再显示一页, 焦点停留在原槽位(即新一页的第一个叶节点)
+        revealNextPage(parentIndex);
+        updateAccessibleFocus(view);
+        return;
+    }
+    if (isCollapseButton(parentIndex, slot)) {
+        collapseLeafs(parentIndex);
+        setLeafFocus(parentIndex, 0, view);
+        return;
+    }
+
+    const QPersistentModelIndex leaf = leafAtSlot(parentIndex, slot);
+    if (leaf.isValid()) {
+        emit leafClicked(leaf);
+        showLeafDetailsDialog(leaf);
+    }
+}
+
+void LeafButtonDelegate::deleteLeafButton(const QModelIndex &parentIndex, int slot)
+{
+    const QPersistentModelIndex leaf = leafAtSlot(parentIndex, slot);
+    if (leaf.isValid())
+        emit leafDeleted(leaf);
+}
+
+QModelIndex LeafButtonDelegate::leafAt(const QModelIndex &parentIndex, const QPoint &pos) const
+{
+    const QPersistentModelIndex persistentIndex(parentIndex);
+    auto leafMapIt = m_leafButtonsInfo.constFind(persistentIndex);
+    if (leafMapIt == m_leafButtonsInfo.constEnd() || !m_stripLayouts.value(persistentIndex).clip.contains(pos))
+        return QModelIndex();
+
+    for (auto it = leafMapIt.value().constBegin(); it != leafMapIt.value().constEnd(); ++it) {
+        if (it.value().leafRect.contains(pos) && !it.value().deleteButtonRect.contains(pos))
+            return it.key();
+    }
+    return QModelIndex();
+}
+
+QModelIndexList LeafButtonDelegate::dragLeafs(const QModelIndex &leafIndex) const
+{
+    if (!m_selectedLeafs.contains(QPersistentModelIndex(leafIndex)))
+        return { leafIndex };
+
+    // 两棵树共用代理时选中集合可能混有另一个模型的索引, 只取同一模型的
+    QModelIndexList leafs;
+    for (const QPersistentModelIndex &leaf : m_selectedLeafs) {
+        if (leaf.isValid() && leaf.model() == leafIndex.model())
+            leafs.append(leaf);
+    }
+    return leafs;
+}
+
+QModelIndexList LeafButtonDelegate::selectedLeafs() const
+{
+    QModelIndexList leafs;
+    for (const QPersistentModelIndex &leaf : m_selectedLeafs) {
+        if (leaf.isValid())
+            leafs.append(leaf);
+    }
+    return leafs;
+}
+
+void LeafButtonDelegate::clearLeafSelection()
+{
+    if (m_selectedLeafs.isEmpty())
+        return;
+
+    QSet<QPersistentModelIndex> parents;
+    for (const QPersistentModelIndex &leaf : std::as_const(m_selectedLeafs)) {
+        if (leaf.isValid())
+            parents.insert(leaf.parent());
+    }
+    m_selectedLeafs.clear();
+    for (const QPersistentModelIndex &parent : std::as_const(parents))
+        emit sizeHintChanged(parent);
+}
+
+void LeafButtonDelegate::toggleLeafSelection(const QModelIndex &leafIndex)
+{
+    const QPersistentModelIndex leaf(leafIndex);
+    if (!m_selectedLeafs.remove(leaf))
+        m_selectedLeafs.insert(leaf);
+    // 选中状态只画在图块之上的叠加层, 不需要使图块失效
+    emit sizeHintChanged(leafIndex.parent());
+}
+
+int LeafButtonDelegate::dropRow(const QModelIndex &parentIndex, const QPoint &pos) const
+{
+    if (!isChildNode(parentIndex))
+        return -1;
+
+    auto leafMapIt = m_leafButtonsInfo.constFind(QPersistentModelIndex(parentIndex));
+    if (leafMapIt == m_leafButtonsInfo.constEnd() || leafMapIt.value().isEmpty())
+        return parentIndex.model()->rowCount(parentIndex);
+
+    const QMap<QPersistentModelIndex, LeafInfo> &leafMap = leafMapIt.value();
+    for (auto it = leafMap.constBegin(); it != leafMap.constEnd(); ++it) {
+        if (pos.x() < it.value().leafRect.center().x())
+            return it.key().row();
+    }
+    // 在最后一个已显示的按钮之后; 翻页未显示的叶节点排在插入位置之后
+    return leafMap.lastKey().row() + 1;
+}
+
+QRect LeafButtonDelegate::dropMarkerRect(const QModelIndex &parentIndex, int row) const
+{
+    auto leafMapIt = m_leafButtonsInfo.constFind(QPersistentModelIndex(parentIndex));
+    if (leafMapIt == m_leafButtonsInfo.constEnd() || leafMapIt.value().isEmpty())
+        return QRect();
+
+    const QMap<QPersistentModelIndex, LeafInfo> &leafMap = leafMapIt.value();
+    for (auto it = leafMap.constBegin(); it != leafMap.constEnd(); ++it) {
+        if (it.key().row() >= row) {
+            const QRect &rect = it.value().leafRect;
+            return QRect(rect.left() - LeafStrip::ButtonSpacing / 2 - 1, rect.top(), 2, rect.height());
+        }
+    }
+    const QRect &last = leafMap.last().leafRect;
+    return QRect(last.right() + LeafStrip::ButtonSpacing / 2, last.top(), 2, last.height());
+}
+
+void LeafButtonDelegate::revealNextPage(const QModelIndex &parentIndex)
+{
+    const QPersistentModelIndex persistentIndex(parentIndex);
+    const int total = parentIndex.model()->rowCount(parentIndex);
+    const int revealed = m_revealedLeafs.value(persistentIndex, LeafStrip::MaxVisibleLeafs);
+    m_revealedLeafs.insert(persistentIndex, qMin(total, revealed + m_leafPageSize));
+    if (m_tileRenderer)
+        m_tileRenderer->invalidate();
+    emit sizeHintChanged(parentIndex);
+}
+
+void LeafButtonDelegate::collapseLeafs(const QModelIndex &parentIndex)
+{
+    m_stripOffsets.remove(QPersistentModelIndex(parentIndex));
+    if (m_revealedLeafs.remove(QPersistentModelIndex(parentIndex))) {
+        if (m_tileRenderer)
+            m_tileRenderer->invalidate();
+        emit sizeHintChanged(parentIndex);
+    }
+}
+
+QPersistentModelIndex LeafButtonDelegate::leafAtSlot(const QModelIndex &parentIndex, int slot) const
+{
+    // 叶节点按钮的槽位就是它在父节点中的行号
+    const LeafStrip::StripLayout strip = m_stripLayouts.value(QPersistentModelIndex(parentIndex));
+    if (!parentIndex.isValid() || slot < 0 || slot >= strip.leafCount)
+        return QPersistentModelIndex();
+
+    const QModelIndex leaf = parentIndex.model()->index(slot, 0, parentIndex);
+    return leaf.model()->hasChildren(leaf) ? QPersistentModelIndex() : QPersistentModelIndex(leaf);
+}
+
+void LeafButtonDelegate::setLeafFocus(const QModelIndex &parentIndex, int slot, QAbstractItemView *view)
+{
+    const QRect oldRect = m_focusParent.isValid() ? leafButtonRect(m_focusParent, m_focusSlot) : QRect();
+
+    if (slot >= 0 && parentIndex.isValid()) {
+        m_focusParent = QPersistentModelIndex(parentIndex);
+        m_focusSlot = slot;
+    } else {
+        m_focusParent = QPersistentModelIndex();
+        m_focusSlot = -1;
+    }
+
+    if (m_focusParent.isValid())
+        ensureSlotVisible(m_focusParent, m_focusSlot, view);
+    const QRect newRect = m_focusParent.isValid() ? leafButtonRect(m_focusParent, m_focusSlot) : QRect();
+
+    // 只重绘焦点变化涉及的两个按钮(包含焦点框的外扩区域), 不触发 sizeHintChanged 重新布局
+    if (!oldRect.isEmpty())
+        view->viewport()->update(oldRect.adjusted(-3, -3, 3, 3));
+    if (!newRect.isEmpty() && newRect != oldRect)
+        view->viewport()->update(newRect.adjusted(-3, -3, 3, 3));
+
+    updateAccessibleFocus(view);
+}
+
+void LeafButtonDelegate::updateAccessibleFocus(QAbstractItemView *view)
+{
+#ifndef QT_NO_ACCESSIBILITY
+    if (m_accessibleFocusId) {
+        QAccessible::deleteAccessibleInterface(m_accessibleFocusId);
+        m_accessibleFocusId = 0;
+    }
+
+    // 没有辅助技术在监听时不创建任何对象
+    if (!QAccessible::isActive() || !m_focusParent.isValid())
+        return;
+
+    LeafButtonAccessible *iface = new LeafButtonAccessible(view, this, m_focusParent, m_focusSlot);
+    m_accessibleFocusId = QAccessible::registerAccessibleInterface(iface);
+    QAccessibleEvent event(iface, QAccessible::Focus);
+    QAccessible::updateAccessibility(&event);
+#else
+    Q_UNUSED(view);
+#endif
+}
+
 bool LeafButtonDelegate::isLeafNode(const QModelIndex &index) const
 {
     // 叶节点是没有子节点但其父节点有子节点的节点
@@ -130,124 +571,434 @@ bool LeafButtonDelegate::isChildNode(const QModelIndex &index) const
     return index.isValid() && index.model()->hasChildren(index) && index.parent().isValid();
 }
 
-void LeafButtonDelegate::updateLeafLayouts(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+void LeafButtonDelegate::updateLeafLayouts(const QFontMetrics &fontMetrics, const QStyleOptionViewItem &option,
+                                           const QModelIndex &index) const
 {
-    // 清除该父节点的现有布局
-    m_leafButtonsInfo[QPersistentModelIndex(index)].clear();
+    PERF_SCOPE(Perf::LeafLayout);
 
-    const int LEAF_BUTTON_WIDTH = 80;
-    const int LEAF_BUTTON_HEIGHT = 30;
-    const int LEAF_BUTTON_SPACING = 5;
-    const int DELETE_BUTTON_SIZE = 16;
-    const int MAX_VISIBLE_LEAFS = 2;  // 最多显示2个叶节点
+    QString text;
+    {
+        PERF_SCOPE(Perf::ModelData);
+        text = index.data().toString();
+    }
+    layoutStripButtons(index, stripLayout(option.rect, fontMetrics.horizontalAdvance(text), index));
+}
 
-    // 计算叶节点按钮的可用空间
-    QRect contentRect = option.rect;
-    int textWidth = painter->fontMetrics().width(index.data().toString()) + 40;
+LeafStrip::StripLayout LeafButtonDelegate::stripLayout(const QRect &rowRect, int textWidth, const QModelIndex &index) const
+{
+    const QPersistentModelIndex persistentIndex(index);
+    const int revealedLeafs = m_revealedLeafs.value(persistentIndex, LeafStrip::MaxVisibleLeafs);
+    const int totalLeafs = childRoles(index, 0).rowCount;
+    const int visibleLeafs = qMin(totalLeafs, revealedLeafs);
 
-    // 叶节点按钮的起始位置
-    int startX = contentRect.left() + textWidth + 20; // 文本后20px的间距
-    int centerY = contentRect.center().y();
+    // 已翻页的叶节点数超过可见宽度时按钮条可以水平滚动
+    return LeafStrip::layoutStrip(rowRect, textWidth, visibleLeafs, visibleLeafs < totalLeafs,
+                                  revealedLeafs > LeafStrip::MaxVisibleLeafs, m_stripOffsets.value(persistentIndex));
+}
 
-    QPersistentModelIndex persistentIndex(index);
-    bool isExpanded = m_expandedNodes.contains(persistentIndex);
-
-    // 获取此索引的所有子节点数量
-    int totalLeafs = index.model()->rowCount(index);
-    int visibleLeafs = isExpanded ? totalLeafs : qMin(totalLeafs, MAX_VISIBLE_LEAFS);
-
-    // 遍历所有需要显示的叶节点
-    for (int i = 0; i < visibleLeafs; i++) {
-        QModelIndex leafIndex = index.model()->index(i, 0, index);
-        if (isLeafNode(leafIndex)) {
-            // 计算叶节点按钮矩形
-            QRect leafRect(startX, centerY - LEAF_BUTTON_HEIGHT/2,
-                           LEAF_BUTTON_WIDTH, LEAF_BUTTON_HEIGHT);
-
-            // 计算删除按钮(X)矩形
-            QRect deleteRect(
-                leafRect.right() - DELETE_BUTTON_SIZE - 2,
-                leafRect.top() + 2,
-                DELETE_BUTTON_SIZE,
-                DELETE_BUTTON_SIZE
-                );
-
-            // 存储该叶节点的信息
-            LeafInfo info;
-            info.leafRect = leafRect;
-            info.deleteButtonRect = deleteRect;
-            m_leafButtonsInfo[persistentIndex][QPersistentModelIndex(leafIndex)] = info;
-
-            // 移动到下一个位置
-            startX += LEAF_BUTTON_WIDTH + LEAF_BUTTON_SPACING;
-        }
-    }
+void LeafButtonDelegate::layoutStripButtons(const QModelIndex &index, const LeafStrip::StripLayout &strip) const
+{
+    const QPersistentModelIndex persistentIndex(index);
+    m_stripLayouts.insert(persistentIndex, strip);
+
+    // 只布局与可见区域相交的叶节点按钮, 一行有上万个叶节点时也只有一屏宽的几个;
+    // 文本按前缀取回, 向右滚动时每个子节点只取一次
+    QMap<QPersistentModelIndex, LeafInfo> &leafMap = m_leafButtonsInfo[persistentIndex];
+    leafMap.clear();
+    const int lastLeaf = strip.lastVisibleLeaf();
+    const ChildRoleCache &childRoleCache = childRoles(index, lastLeaf + 1);
+    for (int i = strip.firstVisibleLeaf(); i <= lastLeaf; ++i) {
+        // index 本身是子节点(有子节点且父节点有效), 因此 isLeafNode 只需判断叶节点没有子节点;
+        // 有子节点的子行不画按钮, 但保留它的槽位, 位置才能直接由行号算出
+        if (childRoleCache.hasChildren.at(i))
+            continue;
 
-    // 如果有更多叶节点且没有展开，添加"..."按钮
-    if (!isExpanded && totalLeafs > MAX_VISIBLE_LEAFS) {
-        QRect moreRect(startX, centerY - LEAF_BUTTON_HEIGHT/2,
-                       LEAF_BUTTON_WIDTH/2, LEAF_BUTTON_HEIGHT);
+        LeafInfo info;
+        info.leafRect = strip.slotRect(i);
+        info.deleteButtonRect = LeafStrip::deleteButtonRect(info.leafRect);
+        leafMap.insert(QPersistentModelIndex(index.model()->index(i, 0, index)), info);
+    }
 
+    // "..."和收起按钮同样只在可见时布局
+    const QRect moreRect = strip.hasMore ? strip.slotRect(strip.leafCount) : QRect();
+    if (moreRect.intersects(strip.clip)) {
         LeafInfo moreInfo;
         moreInfo.leafRect = moreRect;
         moreInfo.isMoreButton = true;
         m_moreButtonsInfo[persistentIndex] = moreInfo;
     } else {
-        // 如果已展开或没有更多叶节点，移除"..."按钮
         m_moreButtonsInfo.remove(persistentIndex);
     }
+
+    const QRect collapseRect = strip.hasCollapse ? strip.slotRect(strip.slotCount() - 1) : QRect();
+    if (collapseRect.intersects(strip.clip)) {
+        LeafInfo collapseInfo;
+        collapseInfo.leafRect = collapseRect;
+        m_collapseButtonsInfo[persistentIndex] = collapseInfo;
+    } else {
+        m_collapseButtonsInfo.remove(persistentIndex);
+    }
 }
 
-void LeafButtonDelegate::paintLeafButtons(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+int LeafButtonDelegate::stripOffset(const QModelIndex &parentIndex) const
+{
+    const QPersistentModelIndex persistentIndex(parentIndex);
+    auto stripIt = m_stripLayouts.constFind(persistentIndex);
+    return stripIt != m_stripLayouts.constEnd() ? stripIt.value().offset : m_stripOffsets.value(persistentIndex);
+}
+
+bool LeafButtonDelegate::setStripOffset(const QModelIndex &parentIndex, int offset)
+{
+    // 还没有布局过的行不知道可见宽度, 也就没有可滚动的范围
+    const QPersistentModelIndex persistentIndex(parentIndex);
+    auto stripIt = m_stripLayouts.constFind(persistentIndex);
+    if (stripIt == m_stripLayouts.constEnd())
+        return false;
+
+    LeafStrip::StripLayout strip = stripIt.value();
+    offset = qBound(0, offset, strip.maxOffset());
+    if (offset == strip.offset)
+        return false;
+
+    strip.offset = offset;
+    if (offset > 0)
+        m_stripOffsets.insert(persistentIndex, offset);
+    else
+        m_stripOffsets.remove(persistentIndex);
+
+    // 几何不依赖字体, 立即按新的滚动量重新布局可见的按钮, 命中测试不必等到下次绘制;
+    // 调用方只需重绘这一行, 不发出 sizeHintChanged
+    layoutStripButtons(parentIndex, strip);
+    return true;
+}
+
+bool LeafButtonDelegate::scrollStrip(const QModelIndex &parentIndex, int dx)
+{
+    return setStripOffset(parentIndex, stripOffset(parentIndex) + dx);
+}
+
+void LeafButtonDelegate::ensureSlotVisible(const QModelIndex &parentIndex, int slot, QAbstractItemView *view)
+{
+    const LeafStrip::StripLayout strip = m_stripLayouts.value(QPersistentModelIndex(parentIndex));
+    const QRect rect = strip.slotRect(slot);
+    if (rect.isEmpty() || strip.clip.isEmpty())
+        return;
+
+    int offset = strip.offset;
+    if (rect.left() < strip.clip.left())
+        offset -= strip.clip.left() - rect.left();
+    else if (rect.right() > strip.clip.right())
+        offset += rect.right() - strip.clip.right();
+    if (setStripOffset(parentIndex, offset))
+        view->viewport()->update(strip.clip);
+}
+
+const LeafButtonDelegate::ChildRoleCache &LeafButtonDelegate::childRoles(const QModelIndex &parent, int fetchCount) const
+{
+    const QAbstractItemModel *model = parent.model();
+
+    auto it = m_childRoleCache.find(parent);
+    if (it == m_childRoleCache.end()) {
+        watchModel(model);
+        ChildRoleCache cache;
+        cache.rowCount = model->rowCount(parent);
+        it = m_childRoleCache.insert(parent, cache);
+    }
+
+    // 按需补齐前 fetchCount 个子节点, 已取回的部分不再访问模型
+    ChildRoleCache &cache = it.value();
+    const int target = qMin(fetchCount, cache.rowCount);
+    if (cache.labels.size() >= target)
+        return cache;
+
+    PERF_SCOPE(Perf::ModelData);
+
+    cache.labels.reserve(target);
+    cache.hasChildren.reserve(target);
+
+    for (int i = cache.labels.size(); i < target; ++i) {
+        const QModelIndex child = model->index(i, 0, parent);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        // Qt 6: 文本与 HasChildrenRole 通过一次 multiData 取回; 不提供该角色的模型再调用 hasChildren()
+        QModelRoleData roleData[] = { QModelRoleData(Qt::DisplayRole), QModelRoleData(HasChildrenRole) };
+        model->multiData(child, roleData);
+        cache.labels.append(roleData[0].data().toString());
+        const QVariant hasChildren = roleData[1].data();
+        cache.hasChildren.append(hasChildren.isValid() ? hasChildren.toBool() : model->hasChildren(child));
+#else
+        cache.labels.append(model->data(child, Qt::DisplayRole).toString());
+        cache.hasChildren.append(model->hasChildren(child));
+#endif
+    }
+
+    return cache;
+}
+
+void LeafButtonDelegate::watchModel(const QAbstractItemModel *model) const
+{
+    if (m_watchedModels.contains(model))
+        return;
+    m_watchedModels.insert(model);
+
+    LeafButtonDelegate *self = const_cast<LeafButtonDelegate *>(this);
+    auto invalidateAll = [self, model]{ self->invalidateChildRoles(model); };
+
+    // 数据变化只影响所在父节点的缓存和图块; 结构变化会使行号失效, 清除该模型的全部缓存
+    connect(model, &QAbstractItemModel::dataChanged, self,
+            [self](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        self->m_childRoleCache.remove(topLeft.parent());
+        self->invalidateRowTiles(topLeft, bottomRight);
+    });
+    connect(model, &QAbstractItemModel::rowsInserted, self, invalidateAll);
+    connect(model, &QAbstractItemModel::rowsRemoved, self, invalidateAll);
+    connect(model, &QAbstractItemModel::rowsMoved, self, invalidateAll);
+    connect(model, &QAbstractItemModel::layoutChanged, self, invalidateAll);
+    connect(model, &QAbstractItemModel::modelReset, self, invalidateAll);
+    connect(model, &QObject::destroyed, self, [self, model]{
+        self->invalidateChildRoles(model);
+        self->m_watchedModels.remove(model);
+    });
+}
+
+void LeafButtonDelegate::invalidateChildRoles(const QAbstractItemModel *model) const
+{
+    if (m_tileRenderer)
+        m_tileRenderer->invalidate();
+
+    for (auto it = m_childRoleCache.begin(); it != m_childRoleCache.end();) {
+        if (it.key().model() == model)
+            it = m_childRoleCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+void LeafButtonDelegate::invalidateRowTiles(const QModelIndex &topLeft, const QModelIndex &bottomRight) const
+{
+    if (!m_tileRenderer || !topLeft.isValid())
+        return;
+
+    // 变化的行本身, 以及把这些行画成叶节点按钮的父节点行
+    const QAbstractItemModel *model = topLeft.model();
+    const QModelIndex parent = topLeft.parent();
+    QSet<QPair<quintptr, int>> rows;
+    if (parent.isValid())
+        rows.insert(qMakePair(parent.internalId(), parent.row()));
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        rows.insert(qMakePair(index.internalId(), row));
+    }
+    m_tileRenderer->invalidateRows(model, rows);
+}
+
+void LeafButtonDelegate::paintLeafButtons(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index,
+                                          bool overlayOnly) const
 {
     painter->save();
 
     QPersistentModelIndex persistentIndex(index);
+    const ChildRoleCache &childRoleCache = childRoles(index, 0);
+    const LeafStrip::StripLayout strip = m_stripLayouts.value(persistentIndex);
+    painter->setClipRect(strip.clip, Qt::IntersectClip);
 
-    // 绘制叶节点按钮
+    // 绘制叶节点按钮(只有可见的那一段已布局), 槽位即行号
     auto &leafMap = m_leafButtonsInfo[persistentIndex];
     for (auto it = leafMap.begin(); it != leafMap.end(); ++it) {
         QModelIndex leafIndex = it.key();
         const LeafInfo &info = it.value();
+        const int slot = leafIndex.row();
 
-        // 绘制叶节点按钮
-        QColor buttonColor = (leafIndex == m_hoverIndex) ? QColor(220, 230, 255) : QColor(230, 230, 230);
-        painter->setPen(QPen(Qt::gray));
-        painter->setBrush(buttonColor);
-        painter->drawRoundedRect(info.leafRect, 5, 5);
-
-        // 绘制叶节点文本
-        painter->setPen(Qt::black);
-        painter->drawText(info.leafRect, Qt::AlignCenter, leafIndex.data().toString());
-
-        // 如果此叶节点正被悬停，绘制删除按钮(X)
-        if (leafIndex == m_hoverIndex) {
-            painter->setPen(QPen(Qt::red, 2));
-            QRect xRect = info.deleteButtonRect;
-            painter->drawLine(xRect.topLeft(), xRect.bottomRight());
-            painter->drawLine(xRect.topRight(), xRect.bottomLeft());
-        }
+        // 图块中已有按钮的静态外观, 只需补画悬停状态
+        const bool hovered = leafIndex == m_hoverIndex;
+        const bool selected = m_selectedLeafs.contains(it.key());
+        if (!overlayOnly || hovered || selected)
+            LeafStrip::paintLeafButton(painter, info.leafRect, childRoleCache.labels.value(leafIndex.row()),
+                                       hovered, selected);
+
+        if (hasLeafFocus(index, slot))
+            LeafStrip::paintFocusFrame(painter, info.leafRect);
     }
 
     // 绘制"..."按钮（如果存在）
     auto moreIt = m_moreButtonsInfo.find(persistentIndex);
     if (moreIt != m_moreButtonsInfo.end()) {
-        const LeafInfo &moreInfo = moreIt.value();
+        if (!overlayOnly)
+            LeafStrip::paintMoreButton(painter, moreIt.value().leafRect);
 
-        // 绘制"..."按钮
-        QColor moreButtonColor = QColor(200, 200, 200);
-        painter->setPen(QPen(Qt::gray));
-        painter->setBrush(moreButtonColor);
-        painter->drawRoundedRect(moreInfo.leafRect, 5, 5);
+        if (hasLeafFocus(index, strip.leafCount))
+            LeafStrip::paintFocusFrame(painter, moreIt.value().leafRect);
+    }
+
+    // 绘制收起按钮（如果存在）
+    auto collapseIt = m_collapseButtonsInfo.find(persistentIndex);
+    if (collapseIt != m_collapseButtonsInfo.end()) {
+        if (!overlayOnly)
+            LeafStrip::paintCollapseButton(painter, collapseIt.value().leafRect);
 
-        // 绘制"..."文本
-        painter->setPen(Qt::black);
-        painter->drawText(moreInfo.leafRect, Qt::AlignCenter, "...");
+        if (hasLeafFocus(index, strip.slotCount() - 1))
+            LeafStrip::paintFocusFrame(painter, collapseIt.value().leafRect);
     }
 
     painter->restore();
 }
 
+void LeafButtonDelegate::paintTile(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // 布局仍在 GUI 线程上更新, 鼠标和键盘的命中测试依赖它
+    const bool childRow = isChildNode(index);
+    if (childRow)
+        updateLeafLayouts(painter->fontMetrics(), option, index);
+    else
+        watchModel(index.model());
+
+    const qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+    RowTileRenderer::TileKey key = tileKey(option, index, devicePixelRatio);
+    key.stripOffset = m_stripOffsets.value(QPersistentModelIndex(index));
+    QImage image = m_tileRenderer->tile(key);
+    if (image.isNull()) {
+        // 未命中(预取尚未覆盖或已失效): 同步渲染并放入缓存
+        image = RowTileRenderer::renderTile(rowSnapshot(option, index, devicePixelRatio));
+        m_tileRenderer->insertTile(key, image);
+    }
+    painter->drawImage(option.rect.topLeft(), image);
+
+    if (childRow)
+        paintLeafButtons(painter, option, index, true);
+}
+
+bool LeafButtonDelegate::prefetchTile(const QStyleOptionViewItem &option, const QModelIndex &index, qreal devicePixelRatio) const
+{
+    if (!m_tileRenderer || !index.isValid() || option.rect.isEmpty())
+        return false;
+
+    RowTileRenderer::TileKey key = tileKey(option, index, devicePixelRatio);
+    key.stripOffset = m_stripOffsets.value(QPersistentModelIndex(index));
+    if (m_tileRenderer->hasTile(key))
+        return false;
+    return m_tileRenderer->requestTile(key, rowSnapshot(option, index, devicePixelRatio));
+}
+
+bool LeafButtonDelegate::warmRow(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (option.rect.isEmpty() || !isChildNode(index))
+        return false;
+
+    // 已布局过且可见那一段的文本都已取回即为热的
+    auto stripIt = m_stripLayouts.constFind(QPersistentModelIndex(index));
+    auto cacheIt = m_childRoleCache.constFind(index);
+    if (stripIt != m_stripLayouts.constEnd() && cacheIt != m_childRoleCache.constEnd()
+            && cacheIt.value().labels.size() >= qMin(stripIt.value().lastVisibleLeaf() + 1, cacheIt.value().rowCount))
+        return false;
+
+    // 与绘制时相同的布局计算; 行滚入视口后绘制会按实际位置重新计算
+    updateLeafLayouts(option.fontMetrics, option, index);
+    return true;
+}
+
+void LeafButtonDelegate::reportMemory(MemoryReport &report) const
+{
+    const QString subsystem("LeafButtonDelegate");
+    const quint64 handle = sizeof(QPersistentModelIndex);
+
+    // 同一索引的多份持久索引副本共享数据, 按不同的索引去重计数
+    QSet<QModelIndex> persistentIndexes;
+
+    quint64 leafInfos = 0;
+    quint64 layoutBytes = 0;
+    for (auto it = m_leafButtonsInfo.cbegin(); it != m_leafButtonsInfo.cend(); ++it) {
+        persistentIndexes.insert(it.key());
+        layoutBytes += MemoryReport::mapNodeBytes(handle, sizeof(QMap<QPersistentModelIndex, LeafInfo>));
+        for (auto leaf = it.value().cbegin(); leaf != it.value().cend(); ++leaf) {
+            persistentIndexes.insert(leaf.key());
+            layoutBytes += MemoryReport::mapNodeBytes(handle, sizeof(LeafInfo));
+            ++leafInfos;
+        }
+    }
+    report.add(subsystem, "leaf button layouts", layoutBytes, leafInfos);
+
+    quint64 extraButtons = 0;
+    for (const auto *buttons : { &m_moreButtonsInfo, &m_collapseButtonsInfo }) {
+        for (auto it = buttons->cbegin(); it != buttons->cend(); ++it)
+            persistentIndexes.insert(it.key());
+        extraButtons += buttons->size();
+    }
+    report.add(subsystem, "more/collapse buttons",
+               extraButtons * MemoryReport::mapNodeBytes(handle, sizeof(LeafInfo)), extraButtons);
+
+    for (auto it = m_stripLayouts.cbegin(); it != m_stripLayouts.cend(); ++it)
+        persistentIndexes.insert(it.key());
+    for (auto it = m_stripOffsets.cbegin(); it != m_stripOffsets.cend(); ++it)
+        persistentIndexes.insert(it.key());
+    report.add(subsystem, "strip layouts",
+               m_stripLayouts.size() * MemoryReport::hashNodeBytes(handle, sizeof(LeafStrip::StripLayout))
+               + m_stripOffsets.size() * MemoryReport::hashNodeBytes(handle, sizeof(int)),
+               m_stripLayouts.size());
+
+    for (auto it = m_revealedLeafs.cbegin(); it != m_revealedLeafs.cend(); ++it)
+        persistentIndexes.insert(it.key());
+    report.add(subsystem, "paging state",
+               m_revealedLeafs.size() * MemoryReport::hashNodeBytes(handle, sizeof(int)), m_revealedLeafs.size());
+
+    for (const QPersistentModelIndex &leaf : m_selectedLeafs)
+        persistentIndexes.insert(leaf);
+    report.add(subsystem, "leaf selection",
+               m_selectedLeafs.size() * MemoryReport::hashNodeBytes(handle, 0), m_selectedLeafs.size());
+
+    // 文本与模型隐式共享, 只计数组本身
+    quint64 cachedLabels = 0;
+    quint64 roleCacheBytes = 0;
+    for (const ChildRoleCache &cache : std::as_const(m_childRoleCache)) {
+        cachedLabels += cache.labels.size();
+        roleCacheBytes += MemoryReport::hashNodeBytes(sizeof(QModelIndex), sizeof(ChildRoleCache))
+                + quint64(cache.labels.capacity()) * sizeof(QString) + quint64(cache.hasChildren.capacity());
+    }
+    report.add(subsystem, "child role cache", roleCacheBytes, cachedLabels);
+
+    persistentIndexes.remove(QModelIndex());
+    report.add(subsystem, "persistent indexes",
+               persistentIndexes.size() * MemoryReport::persistentIndexBytes(), persistentIndexes.size());
+}
+
+RowSnapshot LeafButtonDelegate::rowSnapshot(const QStyleOptionViewItem &option, const QModelIndex &index,
+                                            qreal devicePixelRatio) const
+{
+    RowSnapshot snapshot;
+    snapshot.size = option.rect.size();
+    snapshot.devicePixelRatio = devicePixelRatio;
+    snapshot.font = option.font;
+    snapshot.palette = option.palette;
+    snapshot.selected = option.state.testFlag(QStyle::State_Selected);
+
+    {
+        PERF_SCOPE(Perf::ModelData);
+        snapshot.text = index.data().toString();
+        const QVariant checkState = index.data(Qt::CheckStateRole);
+        snapshot.checkable = checkState.isValid();
+        snapshot.checkState = Qt::CheckState(checkState.toInt());
+    }
+
+    if (!isChildNode(index))
+        return snapshot;
+
+    // 与 updateLeafLayouts 相同的分页与滚动规则, 只复制可见那一段的文本, 文本取自子节点角色缓存
+    const LeafStrip::StripLayout strip = stripLayout(QRect(QPoint(0, 0), option.rect.size()),
+                                                     QFontMetrics(option.font).horizontalAdvance(snapshot.text), index);
+    const ChildRoleCache &childRoleCache = childRoles(index, strip.lastVisibleLeaf() + 1);
+
+    snapshot.childRow = true;
+    snapshot.stripOffset = strip.offset;
+    snapshot.leafCount = strip.leafCount;
+    for (int i = strip.firstVisibleLeaf(); i <= strip.lastVisibleLeaf(); ++i) {
+        if (!childRoleCache.hasChildren.at(i)) {
+            snapshot.leafLabels.append(childRoleCache.labels.at(i));
+            snapshot.leafSlots.append(i);
+        }
+    }
+    snapshot.hasMore = strip.hasMore;
+    snapshot.hasCollapse = strip.hasCollapse;
+    return snapshot;
+}
+
 void LeafButtonDelegate::showLeafDetailsDialog(const QModelIndex &leafIndex) const
 {
     QDialog dialog(QApplication::activeWindow());
@@ -264,11 +1015,17 @@ void LeafButtonDelegate::showLeafDetailsDialog(const QModelIndex &leafIndex) con
     QLabel *infoLabel = new QLabel(QString("Details for item %1:").arg(leafIndex.data().toString()), &dialog);
     layout->addWidget(infoLabel);
 
-    QLabel *pathLabel = new QLabel(QString("Path: Root > %1 > %2")
-                                       .arg(leafIndex.parent().data().toString())
-                                       .arg(leafIndex.data().toString()), &dialog);
+    QLabel *pathLabel = new QLabel(QString("Path: %1").arg(PathIndex::pathFor(leafIndex)), &dialog);
     layout->addWidget(pathLabel);
 
+    // 各级祖先的子树汇总, 每级一次查找
+    for (QModelIndex ancestor = leafIndex.parent(); ancestor.isValid(); ancestor = ancestor.parent()) {
+        QLabel *summaryLabel = new QLabel(QString("%1: %2").arg(ancestor.data().toString(),
+                                                                 SubtreeAggregates::describe(SubtreeAggregates::summaryFor(ancestor))),
+                                          &dialog);
+        layout->addWidget(summaryLabel);
+    }
+
     QLabel *indexLabel = new QLabel(QString("Index: Row %1, Column %2")
                                         .arg(leafIndex.row())
                                         .arg(leafIndex.column()), &dialog);
@@ -283,3 +1040,51 @@ void LeafButtonDelegate::showLeafDetailsDialog(const QModelIndex &leafIndex) con
 
     dialog.exec();
 }
+
+void LeafButtonDelegate::showAllLeafNodes(const QModelIndex &parentIndex) const
+{
+    QAbstractItemModel *model = const_cast<QAbstractItemModel *>(parentIndex.model());
+    if (!model)
+        return;
+
+    QDialog *dialog = new QDialog(QApplication::activeWindow());
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(QString("All Leaves of %1").arg(parentIndex.data().toString()));
+    dialog->resize(320, 480);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+
+    QLabel *countLabel = new QLabel(QString("%1 leaves").arg(model->rowCount(parentIndex)), dialog);
+    layout->addWidget(countLabel);
+
+    // 直接绑定源模型并以父节点为根, 不复制任何叶节点文本;
+    // 固定行高 + 分批布局, 即使有上百万个叶节点也能立即打开
+    QListView *listView = new QListView(dialog);
+    listView->setModel(model);
+    listView->setRootIndex(parentIndex);
+    listView->setUniformItemSizes(true);
+    listView->setLayoutMode(QListView::Batched);
+    listView->setBatchSize(1000);
+    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    listView->setSelectionMode(QAbstractItemView::SingleSelection);
+    layout->addWidget(listView);
+
+    LeafButtonDelegate *self = const_cast<LeafButtonDelegate *>(this);
+    QObject::connect(listView, &QListView::clicked, self, [self](const QModelIndex &leafIndex) {
+        emit self->leafClicked(leafIndex);
+    });
+
+    // 父节点被删除时关闭浏览器, 否则列表会退回显示模型顶层
+    const QPersistentModelIndex persistentParent(parentIndex);
+    QObject::connect(model, &QAbstractItemModel::rowsRemoved, dialog, [dialog, persistentParent] {
+        if (!persistentParent.isValid())
+            dialog->close();
+    });
+    QObject::connect(model, &QAbstractItemModel::modelReset, dialog, &QDialog::close);
+
+    QPushButton *closeButton = new QPushButton("Close", dialog);
+    layout->addWidget(closeButton);
+    QObject::connect(closeButton, &QPushButton::clicked, dialog, &QDialog::close);
+
+    dialog->show();
+}
@@ -0,0 +1,170 @@
+#ifndef LEAFBUTTONDELEGATE_H
+#define LEAFBUTTONDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QHash>
+#include <QMap>
+#include <QModelIndex>
+#include <QPair>
+#include <QPointer>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+#include <QAccessible>
+#include "leafstrip.h"
+#include "memoryreport.h"
+
+class QAbstractItemView;
+class QHelpEvent;
+class QKeyEvent;
+class RowTileRenderer;
+struct RowSnapshot;
+
+class LeafButtonDelegate : public QStyledItemDelegate, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    explicit LeafButtonDelegate(QObject *parent = nullptr);
+    ~LeafButtonDelegate() override;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    // 悬停提示: 模型没有提供 ToolTipRole 时显示节点路径与子树汇总, 落在叶节点按钮上时为该叶节点
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option,
+                   const QModelIndex &index) override;
+
+    // 每次点击"..."额外显示的叶节点数
+    void setLeafPageSize(int pageSize);
+    int leafPageSize() const;
+
+    // "..."分页状态: 已显示的子节点数, 供视图状态的保存与批量恢复使用
+    int revealedLeafCount(const QModelIndex &parentIndex) const;
+    QModelIndexList pagedParents(const QAbstractItemModel *model) const;
+    // 替换该模型的全部分页状态, 不发出 sizeHintChanged, 由调用方统一重新布局
+    void setRevealedLeafCounts(const QAbstractItemModel *model, const QVector<QPair<QModelIndex, int>> &counts);
+
+    // 图块渲染模式: 设置后行内容由渲染器缓存的图块贴出, 未命中时同步渲染; 传 nullptr 关闭
+    void setTileRenderer(RowTileRenderer *renderer);
+    RowTileRenderer *tileRenderer() const;
+    // 在工作线程中预渲染一行(视图滚动时为视口附近的行调用)
+    bool prefetchTile(const QStyleOptionViewItem &option, const QModelIndex &index, qreal devicePixelRatio) const;
+    // 空闲时预热一行: 取回已显示部分的子节点文本并计算按钮布局, 之后首次绘制与命中测试不再访问模型;
+    // 已经是热的返回 false
+    bool warmRow(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
+    // 按钮条水平滚动: 偏移以像素计, 夹在 [0, 内容宽度 - 可见宽度] 内;
+    // 只重新布局可见的按钮, 不改变行高, 偏移变化时返回 true, 由调用方重绘该行
+    int stripOffset(const QModelIndex &parentIndex) const;
+    bool setStripOffset(const QModelIndex &parentIndex, int offset);
+    bool scrollStrip(const QModelIndex &parentIndex, int dx);
+
+    // 布局缓存、分页状态、子节点角色缓存及其持有的持久索引
+    void reportMemory(MemoryReport &report) const override;
+
+    // 键盘导航: 视图在 keyPressEvent 中转发, 返回 true 表示事件已处理
+    // 焦点按"槽位"标识: 0..n-1 为已显示的子节点(槽位即行号), 之后依次为"..."按钮和收起按钮(若存在)
+    bool handleKeyPress(QKeyEvent *event, QAbstractItemView *view);
+
+    int leafButtonCount(const QModelIndex &parentIndex) const;
+    QRect leafButtonRect(const QModelIndex &parentIndex, int slot) const;
+    QString leafButtonText(const QModelIndex &parentIndex, int slot) const;
+    bool isMoreButton(const QModelIndex &parentIndex, int slot) const;
+    bool isCollapseButton(const QModelIndex &parentIndex, int slot) const;
+    bool hasLeafFocus(const QModelIndex &parentIndex, int slot) const;
+    void activateLeafButton(const QModelIndex &parentIndex, int slot, QAbstractItemView *view);
+    void deleteLeafButton(const QModelIndex &parentIndex, int slot);
+
+    // 拖放: Ctrl+点击叶节点按钮切换选中, 拖动选中的按钮时一起移动
+    QModelIndex leafAt(const QModelIndex &parentIndex, const QPoint &pos) const;
+    QModelIndexList dragLeafs(const QModelIndex &leafIndex) const;
+    QModelIndexList selectedLeafs() const;
+    void clearLeafSelection();
+    // 放下位置对应的插入行: 落在按钮左半边时插到它之前, 否则插到它之后; 不是子节点行时返回 -1
+    int dropRow(const QModelIndex &parentIndex, const QPoint &pos) const;
+    // 插入位置的标记(按钮之间的竖线), 拖动经过时由视图绘制
+    QRect dropMarkerRect(const QModelIndex &parentIndex, int row) const;
+
+signals:
+    void leafClicked(const QModelIndex &leafIndex);
+    void leafDeleted(const QModelIndex &leafIndex);
+
+private:
+    struct LeafInfo {
+        QRect leafRect;
+        QRect deleteButtonRect;
+        bool isMoreButton = false;  // 标识是否为"..."按钮
+    };
+
+    // 存储叶节点按钮信息: 父节点索引 -> (叶节点索引 -> 叶节点信息)
+    mutable QMap<QPersistentModelIndex, QMap<QPersistentModelIndex, LeafInfo>> m_leafButtonsInfo;
+
+    // 额外存储"..."按钮信息: 父节点索引 -> "..."按钮信息
+    mutable QMap<QPersistentModelIndex, LeafInfo> m_moreButtonsInfo;
+
+    // 收起按钮信息: 父节点索引 -> 收起按钮信息(翻过页后才出现)
+    mutable QMap<QPersistentModelIndex, LeafInfo> m_collapseButtonsInfo;
+
+    // 按钮条布局(可见区域、滚动偏移与按钮数): 父节点索引 -> 最近一次布局
+    mutable QHash<QPersistentModelIndex, LeafStrip::StripLayout> m_stripLayouts;
+    // 水平滚动偏移: 父节点索引 -> 像素偏移, 不在表中则为 0
+    QHash<QPersistentModelIndex, int> m_stripOffsets;
+
+    // 分页展开状态: 父节点索引 -> 已显示的子节点数, 不在表中则为默认数量
+    mutable QHash<QPersistentModelIndex, int> m_revealedLeafs;
+    int m_leafPageSize = 20;
+
+    // 当前悬停的叶节点索引
+    mutable QPersistentModelIndex m_hoverIndex;
+
+    // Ctrl+点击选中的叶节点, 节点移动后仍然有效
+    QSet<QPersistentModelIndex> m_selectedLeafs;
+
+    // 键盘焦点所在的行与按钮槽位
+    QPersistentModelIndex m_focusParent;
+    int m_focusSlot = -1;
+
+    // 焦点按钮的无障碍接口 ID, 焦点移动时替换
+    QAccessible::Id m_accessibleFocusId = 0;
+
+    QPointer<RowTileRenderer> m_tileRenderer;
+
+    // 子节点角色缓存: 父节点 -> 其子节点的文本与 hasChildren, 按显示需要逐段取回.
+    // 键是临时的 QModelIndex, 只在行号不变期间有效: 该模型的任何结构变化(插入、删除、移动、布局变化、重置)
+    // 都清除它的全部条目, dataChanged 只清除所在父节点; 没有结构变化时缓存跨帧保留
+    struct ChildRoleCache {
+        int rowCount = 0;
+        QVector<QString> labels;      // 只包含已取回的前 labels.size() 个子节点
+        QVector<bool> hasChildren;
+    };
+    mutable QHash<QModelIndex, ChildRoleCache> m_childRoleCache;
+    mutable QSet<const QAbstractItemModel *> m_watchedModels;
+
+    // 辅助方法
+    bool isLeafNode(const QModelIndex &index) const;
+    bool isChildNode(const QModelIndex &index) const;
+    void updateLeafLayouts(const QFontMetrics &fontMetrics, const QStyleOptionViewItem &option,
+                           const QModelIndex &index) const;
+    LeafStrip::StripLayout stripLayout(const QRect &rowRect, int textWidth, const QModelIndex &index) const;
+    void layoutStripButtons(const QModelIndex &index, const LeafStrip::StripLayout &strip) const;
+    void ensureSlotVisible(const QModelIndex &parentIndex, int slot, QAbstractItemView *view);
+    void paintLeafButtons(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index,
+                          bool overlayOnly = false) const;
+    void paintTile(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    RowSnapshot rowSnapshot(const QStyleOptionViewItem &option, const QModelIndex &index, qreal devicePixelRatio) const;
+    const ChildRoleCache &childRoles(const QModelIndex &parent, int fetchCount) const;
+    void watchModel(const QAbstractItemModel *model) const;
+    void invalidateChildRoles(const QAbstractItemModel *model) const;
+    void invalidateRowTiles(const QModelIndex &topLeft, const QModelIndex &bottomRight) const;
+    void showLeafDetailsDialog(const QModelIndex &leafIndex) const;
+    void showAllLeafNodes(const QModelIndex &parentIndex) const;
+    void revealNextPage(const QModelIndex &parentIndex);
+    void collapseLeafs(const QModelIndex &parentIndex);
+    void toggleLeafSelection(const QModelIndex &leafIndex);
+    QPersistentModelIndex leafAtSlot(const QModelIndex &parentIndex, int slot) const;
+    void setLeafFocus(const QModelIndex &parentIndex, int slot, QAbstractItemView *view);
+    void updateAccessibleFocus(QAbstractItemView *view);
+};
+
+#endif // LEAFBUTTONDELEGATE_H
@@ -0,0 +1,99 @@
+#include "leafmove.h"
+#include <QAbstractProxyModel>
+#include <QHash>
+#include <QPersistentModelIndex>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+
+namespace LeafMove {
+
+namespace {
+
+// 视图可能挂在代理模型上, 逐层映射回源模型
+QModelIndex toSource(QModelIndex index)
+{
+    while (const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel *>(index.model()))
+        index = proxy->mapToSource(index);
+    return index;
+}
+
+// 同一父节点中连续的一段行; 用持久索引记录, 前面的段移动后行号自动更新
+struct Run {
+    QPersistentModelIndex first;
+    int count = 0;
+};
+
+} // namespace
+
+QString mimeType()
+{
+    return QStringLiteral("application/x-leaftree-leafs");
+}
+
+int moveLeafs(const QModelIndexList &leafs, const QModelIndex &targetParent, int targetRow)
+{
+    const QModelIndex parent = toSource(targetParent);
+    QAbstractItemModel *model = const_cast<QAbstractItemModel *>(parent.model());
+    if (!model || leafs.isEmpty())
+        return -1;
+
+    // 按源父节点分组: 父节点保持首次出现的顺序, 组内按行号排列
+    QVector<QModelIndex> parents;
+    QHash<QModelIndex, QVector<int>> rowsByParent;
+    QSet<QPersistentModelIndex> moving;
+    for (const QModelIndex &leaf : leafs) {
+        const QModelIndex source = toSource(leaf);
+        if (!source.isValid() || source.model() != model || model->hasChildren(source))
+            return -1;
+        if (moving.contains(source))
+            continue;
+        moving.insert(source);
+
+        const QModelIndex sourceParent = source.parent();
+        if (!rowsByParent.contains(sourceParent))
+            parents.append(sourceParent);
+        rowsByParent[sourceParent].append(source.row());
+    }
+
+    QVector<Run> runs;
+    for (const QModelIndex &sourceParent : std::as_const(parents)) {
+        QVector<int> &rows = rowsByParent[sourceParent];
+        std::sort(rows.begin(), rows.end());
+        for (int i = 0; i < rows.size();) {
+            int end = i + 1;
+            while (end < rows.size() && rows.at(end) == rows.at(i) + (end - i))
+                ++end;
+            Run run;
+            run.first = QPersistentModelIndex(model->index(rows.at(i), 0, sourceParent));
+            run.count = end - i;
+            runs.append(run);
+            i = end;
+        }
+    }
+
+    // 锚点: 插入位置上第一个不参与移动的行. 各段依次插到它前面, 因此按原有顺序首尾相接;
+    // 锚点本身不会移动, 没有锚点时插到末尾
+    QPersistentModelIndex anchor;
+    if (targetRow >= 0 && targetRow < targetParent.model()->rowCount(targetParent))
+        anchor = toSource(targetParent.model()->index(targetRow, 0, targetParent));
+    while (anchor.isValid() && moving.contains(anchor))
+        anchor = anchor.sibling(anchor.row() + 1, 0);
+
+    int calls = 0;
+    for (const Run &run : std::as_const(runs)) {
+        const QModelIndex sourceParent = run.first.parent();
+        const int first = run.first.row();
+        const int destination = anchor.isValid() ? anchor.row() : model->rowCount(parent);
+
+        // 已经紧挨在插入位置之前(只可能是第一段), 不必移动
+        if (sourceParent == parent && destination == first + run.count)
+            continue;
+        if (!model->moveRows(sourceParent, first, run.count, parent, destination))
+            return -1;
+        ++calls;
+    }
+    return calls;
+}
+
+} // namespace LeafMove
@@ -0,0 +1,23 @@
+#ifndef LEAFMOVE_H
+#define LEAFMOVE_H
+
+#include <QModelIndexList>
+#include <QString>
+
+// 叶节点的移动(拖放与程序调用共用)
+// 节点不经 MIME 数据序列化: 拖放只携带格式标记, 放下时直接对源模型调用 moveRows,
+// 节点本身连同 ID 和持久索引一起重新挂接
+namespace LeafMove {
+
+// QMimeData 中的格式标记, 拖动的索引由拖动源视图持有
+QString mimeType();
+
+// 把 leafs 移到 targetParent 的第 targetRow 行之前, targetRow 超出行数时移到末尾.
+// 索引可以来自代理模型, 统一映射回同一个源模型后按父节点内连续的行分段, 每段一次 moveRows,
+// 各段按原有顺序连续排列在插入位置. 返回 moveRows 的调用次数(都已在目标位置时为 0),
+// 索引不属于同一源模型、含有非叶节点或模型拒绝移动时返回 -1
+int moveLeafs(const QModelIndexList &leafs, const QModelIndex &targetParent, int targetRow);
+
+} // namespace LeafMove
+
+#endif // LEAFMOVE_H
@@ -0,0 +1,641 @@
+#include "leafsortproxymodel.h"
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+namespace {
+
+// 每个并行块至少包含的行数, 太小的块不值得调度
+const int MIN_PARALLEL_CHUNK = 1024;
+
+// 批量插入超过该行数时先追加再整体重排, 而不是逐行二分插入
+const int BULK_INSERT_ROWS = 256;
+
+struct SortValue {
+    double number = 0.0;
+    std::optional<QCollatorSortKey> text;   // 为空时按数值比较
+};
+
+struct SortKey {
+    SortValue group;
+    SortValue value;
+};
+
+bool isNumeric(const QVariant &value)
+{
+    switch (value.userType()) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return true;
+    default:
+        return false;
+    }
+}
+
+SortValue makeSortValue(const QVariant &value, const QCollator &collator)
+{
+    SortValue sortValue;
+    if (isNumeric(value))
+        sortValue.number = value.toDouble();
+    else
+        sortValue.text = collator.sortKey(value.toString());
+    return sortValue;
+}
+
+int compareValues(const SortValue &a, const SortValue &b)
+{
+    if (a.text && b.text)
+        return a.text->compare(*b.text);
+    if (a.text || b.text)
+        return a.text ? 1 : -1;   // 数值排在文本之前
+    return a.number < b.number ? -1 : (a.number > b.number ? 1 : 0);
+}
+
+// QCollator 在首次使用时才初始化内部状态, 副本之间共享这份状态, 因此每个线程各建一个
+QCollator cloneCollator(const QCollator &collator)
+{
+    QCollator clone(collator.locale());
+    clone.setCaseSensitivity(collator.caseSensitivity());
+    clone.setNumericMode(collator.numericMode());
+    clone.setIgnorePunctuation(collator.ignorePunctuation());
+    return clone;
+}
+
+// 按源行号比较: 先比较分组, 再比较排序值, 相等时以源行号兜底, 保证排序稳定
+struct KeyLess {
+    const std::vector<SortKey> &keys;
+    Qt::SortOrder order;
+
+    bool operator()(int a, int b) const
+    {
+        int result = compareValues(keys[a].group, keys[b].group);
+        if (result == 0)
+            result = order == Qt::AscendingOrder ? compareValues(keys[a].value, keys[b].value)
+                                                 : compareValues(keys[b].value, keys[a].value);
+        return result != 0 ? result < 0 : a < b;
+    }
+};
+
+// 把 [0, size) 分成若干块, 返回每块的 [begin, end)
+QVector<QPair<int, int>> splitRanges(int size)
+{
+    const int chunks = qMax(1, qMin(QThread::idealThreadCount(), size / MIN_PARALLEL_CHUNK));
+    QVector<QPair<int, int>> ranges;
+    for (int i = 0; i < chunks; ++i)
+        ranges.append(qMakePair(int(qint64(size) * i / chunks), int(qint64(size) * (i + 1) / chunks)));
+    return ranges;
+}
+
+// 分块并行排序, 然后逐层两两并行归并
+template <typename LessThan>
+void parallelSort(QVector<int> &rows, const LessThan &lessThan)
+{
+    QVector<QPair<int, int>> ranges = splitRanges(rows.size());
+    if (ranges.size() < 2) {
+        std::sort(rows.begin(), rows.end(), lessThan);
+        return;
+    }
+
+    int *data = rows.data();
+    QtConcurrent::blockingMap(ranges, [data, &lessThan](const QPair<int, int> &range) {
+        std::sort(data + range.first, data + range.second, lessThan);
+    });
+
+    while (ranges.size() > 1) {
+        QVector<std::array<int, 3>> merges;
+        QVector<QPair<int, int>> merged;
+        for (int i = 0; i + 1 < ranges.size(); i += 2) {
+            merges.append({ ranges.at(i).first, ranges.at(i).second, ranges.at(i + 1).second });
+            merged.append(qMakePair(ranges.at(i).first, ranges.at(i + 1).second));
+        }
+        if (ranges.size() % 2)
+            merged.append(ranges.last());
+
+        QtConcurrent::blockingMap(merges, [data, &lessThan](const std::array<int, 3> &merge) {
+            std::inplace_merge(data + merge[0], data + merge[1], data + merge[2], lessThan);
+        });
+        ranges = merged;
+    }
+}
+
+} // namespace
+
+struct LeafSortProxyModel::Mapping {
+    QPersistentModelIndex sourceParent;   // 顶层映射为无效索引
+    bool root = false;
+    QVector<int> proxyToSource;
+    QVector<int> sourceToProxy;
+    std::vector<SortKey> keys;            // 按源行号
+};
+
+LeafSortProxyModel::LeafSortProxyModel(QObject *parent)
+    : QAbstractProxyModel(parent)
+{
+    m_collator.setNumericMode(true);
+}
+
+LeafSortProxyModel::~LeafSortProxyModel()
+{
+    clearMappings();
+}
+
+void LeafSortProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    beginResetModel();
+
+    if (sourceModel())
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    clearMappings();
+    QAbstractProxyModel::setSourceModel(model);
+
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &LeafSortProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &LeafSortProxyModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &LeafSortProxyModel::onSourceRowsAboutToBeRemoved);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &LeafSortProxyModel::onSourceRowsRemoved);
+
+        // 移动和源模型自身的布局变化按整体布局变化处理
+        connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, &LeafSortProxyModel::beginLayoutChange);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &LeafSortProxyModel::endLayoutChange);
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &LeafSortProxyModel::beginLayoutChange);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &LeafSortProxyModel::endLayoutChange);
+
+        // 列变化与重置直接重置代理
+        auto beginReset = [this]{ beginResetModel(); };
+        auto endReset = [this]{ clearMappings(); endResetModel(); };
+        connect(model, &QAbstractItemModel::modelAboutToBeReset, this, beginReset);
+        connect(model, &QAbstractItemModel::modelReset, this, endReset);
+        connect(model, &QAbstractItemModel::columnsAboutToBeInserted, this, beginReset);
+        connect(model, &QAbstractItemModel::columnsInserted, this, endReset);
+        connect(model, &QAbstractItemModel::columnsAboutToBeRemoved, this, beginReset);
+        connect(model, &QAbstractItemModel::columnsRemoved, this, endReset);
+        connect(model, &QAbstractItemModel::columnsAboutToBeMoved, this, beginReset);
+        connect(model, &QAbstractItemModel::columnsMoved, this, endReset);
+    }
+
+    endResetModel();
+}
+
+void LeafSortProxyModel::setSortRole(int role)
+{
+    if (m_sortRole == role)
+        return;
+    m_sortRole = role;
+    invalidate();
+}
+
+int LeafSortProxyModel::sortRole() const
+{
+    return m_sortRole;
+}
+
+Qt::SortOrder LeafSortProxyModel::sortOrder() const
+{
+    return m_sortOrder;
+}
+
+void LeafSortProxyModel::setGroupRole(int role)
+{
+    if (m_groupRole == role)
+        return;
+    m_groupRole = role;
+    invalidate();
+}
+
+int LeafSortProxyModel::groupRole() const
+{
+    return m_groupRole;
+}
+
+void LeafSortProxyModel::setCollator(const QCollator &collator)
+{
+    m_collator = collator;
+    invalidate();
+}
+
+QCollator LeafSortProxyModel::collator() const
+{
+    return m_collator;
+}
+
+void LeafSortProxyModel::setParallelThreshold(int rows)
+{
+    m_parallelThreshold = qMax(1, rows);
+}
+
+int LeafSortProxyModel::parallelThreshold() const
+{
+    return m_parallelThreshold;
+}
+
+void LeafSortProxyModel::reportMemory(MemoryReport &report) const
+{
+    quint64 rows = 0;
+    quint64 mappingBytes = 0;
+    quint64 keyBytes = 0;
+    for (const Mapping *mapping : std::as_const(m_mappings)) {
+        rows += mapping->proxyToSource.size();
+        mappingBytes += MemoryReport::hashNodeBytes(sizeof(QModelIndex), sizeof(void *)) + sizeof(Mapping)
+                + MemoryReport::persistentIndexBytes()
+                + quint64(mapping->proxyToSource.capacity() + mapping->sourceToProxy.capacity()) * sizeof(int);
+        keyBytes += quint64(mapping->keys.capacity()) * sizeof(SortKey);
+        for (const SortKey &key : mapping->keys) {
+            // QCollatorSortKey 的私有数据按一个字符串的大小估算
+            if (key.value.text)
+                keyBytes += 3 * sizeof(void *) + 32;
+            if (key.group.text)
+                keyBytes += 3 * sizeof(void *) + 32;
+        }
+    }
+    report.add("LeafSortProxyModel", "row mappings", mappingBytes, m_mappings.size());
+    report.add("LeafSortProxyModel", "sort keys", keyBytes, rows);
+}
+
+void LeafSortProxyModel::sort(int column, Qt::SortOrder order)
+{
+    if (column == m_sortColumn && order == m_sortOrder)
+        return;
+    m_sortColumn = qMax(0, column);
+    m_sortOrder = order;
+    invalidate();
+}
+
+QModelIndex LeafSortProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel())
+        return QModelIndex();
+
+    const Mapping *mapping = static_cast<const Mapping *>(proxyIndex.internalPointer());
+    if (proxyIndex.row() >= mapping->proxyToSource.size())
+        return QModelIndex();
+    return sourceModel()->index(mapping->proxyToSource.at(proxyIndex.row()), proxyIndex.column(),
+                                mapping->sourceParent);
+}
+
+QModelIndex LeafSortProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid() || !sourceModel())
+        return QModelIndex();
+
+    Mapping *mapping = mappingFor(sourceIndex.parent());
+    const int proxyRow = mapping->sourceToProxy.value(sourceIndex.row(), -1);
+    if (proxyRow < 0)
+        return QModelIndex();
+    return createIndex(proxyRow, sourceIndex.column(), mapping);
+}
+
+QModelIndex LeafSortProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column < 0 || !sourceModel())
+        return QModelIndex();
+
+    const QModelIndex sourceParent = mapToSource(parent);
+    if (parent.isValid() && !sourceParent.isValid())
+        return QModelIndex();
+
+    Mapping *mapping = mappingFor(sourceParent);
+    if (row >= mapping->proxyToSource.size() || column >= sourceModel()->columnCount(sourceParent))
+        return QModelIndex();
+    return createIndex(row, column, mapping);
+}
+
+QModelIndex LeafSortProxyModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+
+    const Mapping *mapping = static_cast<const Mapping *>(child.internalPointer());
+    return mapping->root ? QModelIndex() : mapFromSource(mapping->sourceParent);
+}
+
+int LeafSortProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if (!sourceModel() || parent.column() > 0)
+        return 0;
+
+    const QModelIndex sourceParent = mapToSource(parent);
+    if (parent.isValid() && !sourceParent.isValid())
+        return 0;
+    return mappingFor(sourceParent)->proxyToSource.size();
+}
+
+int LeafSortProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (!sourceModel())
+        return 0;
+    return sourceModel()->columnCount(mapToSource(parent));
+}
+
+LeafSortProxyModel::Mapping *LeafSortProxyModel::mappingFor(const QModelIndex &sourceParent) const
+{
+    auto it = m_mappings.constFind(sourceParent);
+    if (it != m_mappings.constEnd())
+        return it.value();
+
+    Mapping *mapping = new Mapping;
+    mapping->sourceParent = sourceParent;
+    mapping->root = !sourceParent.isValid();
+    buildMapping(mapping);
+    m_mappings.insert(sourceParent, mapping);
+    return mapping;
+}
+
+void LeafSortProxyModel::buildMapping(Mapping *mapping) const
+{
+    const int rows = sourceModel()->rowCount(mapping->sourceParent);
+    mapping->keys.clear();
+    computeKeys(mapping, 0, rows);
+
+    mapping->proxyToSource.resize(rows);
+    for (int row = 0; row < rows; ++row)
+        mapping->proxyToSource[row] = row;
+
+    const KeyLess lessThan{ mapping->keys, m_sortOrder };
+
+    if (rows >= m_parallelThreshold)
+        parallelSort(mapping->proxyToSource, lessThan);
+    else
+        std::sort(mapping->proxyToSource.begin(), mapping->proxyToSource.end(), lessThan);
+
+    mapping->sourceToProxy.resize(rows);
+    updateSourceToProxy(mapping, 0, rows - 1);
+}
+
+void LeafSortProxyModel::computeKeys(Mapping *mapping, int first, int count) const
+{
+    if (count <= 0)
+        return;
+
+    // 模型只能在 GUI 线程读取: 先取出角色值, 再计算排序键(可并行)
+    QVector<QVariant> values(count);
+    QVector<QVariant> groups(m_groupRole >= 0 ? count : 0);
+    for (int i = 0; i < count; ++i) {
+        const QModelIndex index = sourceModel()->index(first + i, m_sortColumn, mapping->sourceParent);
+        values[i] = index.data(m_sortRole);
+        if (m_groupRole >= 0)
+            groups[i] = index.data(m_groupRole);
+    }
+
+    std::vector<SortKey> keys(count);
+    auto computeRange = [&](const QPair<int, int> &range, const QCollator &collator) {
+        for (int i = range.first; i < range.second; ++i) {
+            keys[i].value = makeSortValue(values.at(i), collator);
+            if (m_groupRole >= 0)
+                keys[i].group = makeSortValue(groups.at(i), collator);
+        }
+    };
+
+    if (count >= m_parallelThreshold) {
+        QVector<QPair<int, int>> ranges = splitRanges(count);
+        QtConcurrent::blockingMap(ranges, [&](const QPair<int, int> &range) {
+            computeRange(range, cloneCollator(m_collator));
+        });
+    } else {
+        computeRange(qMakePair(0, count), m_collator);
+    }
+
+    mapping->keys.insert(mapping->keys.begin() + first,
+                         std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+}
+
+QModelIndex LeafSortProxyModel::proxyParentFor(const Mapping *mapping) const
+{
+    return mapping->root ? QModelIndex() : mapFromSource(mapping->sourceParent);
+}
+
+void LeafSortProxyModel::updateSourceToProxy(Mapping *mapping, int fromProxyRow, int toProxyRow) const
+{
+    for (int proxyRow = fromProxyRow; proxyRow <= toProxyRow; ++proxyRow)
+        mapping->sourceToProxy[mapping->proxyToSource.at(proxyRow)] = proxyRow;
+}
+
+void LeafSortProxyModel::repositionRows(Mapping *mapping, int first, int last)
+{
+    const KeyLess lessThan{ mapping->keys, m_sortOrder };
+    QVector<int> &rows = mapping->proxyToSource;
+
+    // 未变化的行仍然有序. 变化的行逐个二分插回这个有序序列, 尚未处理的变化行停在旧位置,
+    // 不参与查找, 否则序列不再有序, 二分查找的结果不可靠
+    QVector<int> settled;
+    settled.reserve(rows.size());
+    for (int sourceRow : std::as_const(rows)) {
+        if (sourceRow < first || sourceRow > last)
+            settled.append(sourceRow);
+    }
+
+    const QModelIndex proxyParent = proxyParentFor(mapping);
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+        const auto next = std::lower_bound(settled.begin(), settled.end(), sourceRow, lessThan);
+        // 放到有序序列中后一行之前, 没有后一行时放到末尾; target 以移动前的行号表示
+        const int target = next == settled.end() ? rows.size() : mapping->sourceToProxy.at(*next);
+        settled.insert(next, sourceRow);
+
+        const int oldRow = mapping->sourceToProxy.at(sourceRow);
+        if (target == oldRow || target == oldRow + 1)
+            continue;
+
+        const int newRow = target > oldRow ? target - 1 : target;
+        beginMoveRows(proxyParent, oldRow, oldRow, proxyParent, target);
+        rows.remove(oldRow);
+        rows.insert(newRow, sourceRow);
+        updateSourceToProxy(mapping, qMin(oldRow, newRow), qMax(oldRow, newRow));
+        endMoveRows();
+    }
+}
+
+void LeafSortProxyModel::rekeyMappings()
+{
+    // 源模型结构变化后旧的 QModelIndex 键已失效, 按持久索引重新建立;
+    // 父节点已被删除的映射一并释放(指向它们的代理持久索引已随删除失效)
+    QHash<QModelIndex, Mapping *> rekeyed;
+    for (Mapping *mapping : std::as_const(m_mappings)) {
+        if (mapping->root)
+            rekeyed.insert(QModelIndex(), mapping);
+        else if (mapping->sourceParent.isValid())
+            rekeyed.insert(mapping->sourceParent, mapping);
+        else
+            delete mapping;
+    }
+    m_mappings.swap(rekeyed);
+}
+
+void LeafSortProxyModel::clearMappings()
+{
+    qDeleteAll(m_mappings);
+    m_mappings.clear();
+}
+
+void LeafSortProxyModel::beginLayoutChange()
+{
+    emit layoutAboutToBeChanged();
+
+    m_layoutProxyIndexes = persistentIndexList();
+    m_layoutSourceIndexes.clear();
+    for (const QModelIndex &proxyIndex : std::as_const(m_layoutProxyIndexes))
+        m_layoutSourceIndexes.append(QPersistentModelIndex(mapToSource(proxyIndex)));
+}
+
+void LeafSortProxyModel::endLayoutChange()
+{
+    clearMappings();
+
+    QModelIndexList newIndexes;
+    for (const QPersistentModelIndex &sourceIndex : std::as_const(m_layoutSourceIndexes))
+        newIndexes.append(mapFromSource(sourceIndex));
+    changePersistentIndexList(m_layoutProxyIndexes, newIndexes);
+    m_layoutProxyIndexes.clear();
+    m_layoutSourceIndexes.clear();
+
+    emit layoutChanged();
+}
+
+void LeafSortProxyModel::invalidate()
+{
+    if (m_mappings.isEmpty())
+        return;
+    beginLayoutChange();
+    endLayoutChange();
+}
+
+void LeafSortProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                             const QVector<int> &roles)
+{
+    // 父节点尚未被访问过时视图不持有它的子节点索引, 无需处理
+    Mapping *mapping = m_mappings.value(topLeft.parent());
+    if (!mapping)
+        return;
+
+    const bool sortColumnChanged = topLeft.column() <= m_sortColumn && m_sortColumn <= bottomRight.column();
+    const bool orderChanged = sortColumnChanged
+            && (roles.isEmpty() || roles.contains(m_sortRole) || (m_groupRole >= 0 && roles.contains(m_groupRole)));
+
+    if (orderChanged) {
+        const int count = bottomRight.row() - topLeft.row() + 1;
+        if (count >= BULK_INSERT_ROWS) {
+            // 大范围变化: 整体重排一次, 映射随之重建
+            beginLayoutChange();
+            endLayoutChange();
+            mapping = mappingFor(topLeft.parent());
+        } else {
+            mapping->keys.erase(mapping->keys.begin() + topLeft.row(),
+                                mapping->keys.begin() + topLeft.row() + count);
+            computeKeys(mapping, topLeft.row(), count);
+            repositionRows(mapping, topLeft.row(), bottomRight.row());
+        }
+    }
+
+    // 转发: 映射到代理行后按连续区间发出
+    QVector<int> proxyRows;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row)
+        proxyRows.append(mapping->sourceToProxy.at(row));
+    std::sort(proxyRows.begin(), proxyRows.end());
+
+    const QModelIndex proxyParent = proxyParentFor(mapping);
+    int first = 0;
+    for (int i = 1; i <= proxyRows.size(); ++i) {
+        if (i < proxyRows.size() && proxyRows.at(i) == proxyRows.at(i - 1) + 1)
+            continue;
+        emit dataChanged(index(proxyRows.at(first), topLeft.column(), proxyParent),
+                         index(proxyRows.at(i - 1), bottomRight.column(), proxyParent), roles);
+        first = i;
+    }
+}
+
+void LeafSortProxyModel::onSourceRowsInserted(const QModelIndex &sourceParent, int first, int last)
+{
+    rekeyMappings();
+
+    Mapping *mapping = m_mappings.value(sourceParent);
+    if (!mapping)
+        return;
+
+    const int count = last - first + 1;
+    QVector<int> &order = mapping->proxyToSource;
+    for (int &sourceRow : order) {
+        if (sourceRow >= first)
+            sourceRow += count;
+    }
+    mapping->sourceToProxy.insert(first, count, -1);
+    computeKeys(mapping, first, count);
+
+    const QModelIndex proxyParent = proxyParentFor(mapping);
+
+    if (count >= BULK_INSERT_ROWS) {
+        // 大批插入: 先追加到末尾, 再整体重排一次
+        const int oldSize = order.size();
+        beginInsertRows(proxyParent, oldSize, oldSize + count - 1);
+        for (int row = first; row <= last; ++row)
+            order.append(row);
+        updateSourceToProxy(mapping, oldSize, order.size() - 1);
+        endInsertRows();
+
+        beginLayoutChange();
+        endLayoutChange();
+        return;
+    }
+
+    const KeyLess lessThan{ mapping->keys, m_sortOrder };
+
+    // 逐行二分插入
+    for (int row = first; row <= last; ++row) {
+        const int proxyRow = int(std::lower_bound(order.begin(), order.end(), row, lessThan) - order.begin());
+        beginInsertRows(proxyParent, proxyRow, proxyRow);
+        order.insert(proxyRow, row);
+        updateSourceToProxy(mapping, proxyRow, order.size() - 1);
+        endInsertRows();
+    }
+}
+
+void LeafSortProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &sourceParent, int first, int last)
+{
+    Mapping *mapping = m_mappings.value(sourceParent);
+    if (!mapping)
+        return;
+
+    QVector<int> proxyRows;
+    for (int row = first; row <= last; ++row)
+        proxyRows.append(mapping->sourceToProxy.at(row));
+    std::sort(proxyRows.begin(), proxyRows.end());
+
+    // 从后往前按连续区间删除, 前面的代理行号不受影响
+    const QModelIndex proxyParent = proxyParentFor(mapping);
+    QVector<int> &order = mapping->proxyToSource;
+    int end = proxyRows.size() - 1;
+    for (int i = proxyRows.size() - 2; i >= -1; --i) {
+        if (i >= 0 && proxyRows.at(i) == proxyRows.at(i + 1) - 1)
+            continue;
+        const int from = proxyRows.at(i + 1);
+        const int to = proxyRows.at(end);
+        beginRemoveRows(proxyParent, from, to);
+        for (int p = from; p <= to; ++p)
+            mapping->sourceToProxy[order.at(p)] = -1;
+        order.remove(from, to - from + 1);
+        updateSourceToProxy(mapping, from, order.size() - 1);
+        endRemoveRows();
+        end = i;
+    }
+}
+
+void LeafSortProxyModel::onSourceRowsRemoved(const QModelIndex &sourceParent, int first, int last)
+{
+    if (Mapping *mapping = m_mappings.value(sourceParent)) {
+        const int count = last - first + 1;
+        for (int &sourceRow : mapping->proxyToSource) {
+            if (sourceRow > last)
+                sourceRow -= count;
+        }
+        mapping->keys.erase(mapping->keys.begin() + first, mapping->keys.begin() + first + count);
+        mapping->sourceToProxy.remove(first, count);
+    }
+
+    rekeyMappings();
+}
@@ -0,0 +1,90 @@
+#ifndef LEAFSORTPROXYMODEL_H
+#define LEAFSORTPROXYMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QCollator>
+#include <QHash>
+#include <QVector>
+#include "memoryreport.h"
+
+// 按父节点对子节点排序的树代理, 用于让叶节点按钮按文本或自定义角色排列, 可选先按分组角色分组
+// 每个父节点的排序映射在首次访问时建立: 排序键预先计算(文本使用 QCollator 排序键),
+// 子节点较多时并行计算排序键并分块并行排序后归并.
+// 之后的 dataChanged/rowsInserted 只对受影响的行做二分插入, 不重新排序整个父节点.
+// hasChildren/rowCount/parent 与源模型一致, 因此 LeafButtonDelegate 的 isLeafNode/isChildNode 判断不受影响
+class LeafSortProxyModel : public QAbstractProxyModel, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    explicit LeafSortProxyModel(QObject *parent = nullptr);
+    ~LeafSortProxyModel() override;
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    // 排序角色默认为 DisplayRole; 数值类型按数值比较, 其他按本地化文本比较
+    void setSortRole(int role);
+    int sortRole() const;
+    Qt::SortOrder sortOrder() const;
+
+    // 分组角色: 先按该角色分组(组按升序), 组内再按排序角色排序; -1 表示不分组
+    void setGroupRole(int role);
+    int groupRole() const;
+
+    // 默认使用当前语言环境并开启数字模式("Leaf 9" 排在 "Leaf 10" 之前)
+    void setCollator(const QCollator &collator);
+    QCollator collator() const;
+
+    // 子节点数不少于该值时并行计算排序键和排序
+    void setParallelThreshold(int rows);
+    int parallelThreshold() const;
+
+    void reportMemory(MemoryReport &report) const override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+private:
+    struct Mapping;
+
+    Mapping *mappingFor(const QModelIndex &sourceParent) const;
+    void buildMapping(Mapping *mapping) const;
+    void computeKeys(Mapping *mapping, int first, int count) const;
+    QModelIndex proxyParentFor(const Mapping *mapping) const;
+    void updateSourceToProxy(Mapping *mapping, int fromProxyRow, int toProxyRow) const;
+    // 源行 [first, last] 的排序键已更新, 把它们移到新位置
+    void repositionRows(Mapping *mapping, int first, int last);
+    void rekeyMappings();
+    void clearMappings();
+    void beginLayoutChange();
+    void endLayoutChange();
+    void invalidate();
+
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSourceRowsInserted(const QModelIndex &sourceParent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &sourceParent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &sourceParent, int first, int last);
+
+    // 源父节点 -> 映射; 结构变化后按持久索引重新建立键
+    mutable QHash<QModelIndex, Mapping *> m_mappings;
+
+    int m_sortRole = Qt::DisplayRole;
+    int m_sortColumn = 0;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    int m_groupRole = -1;
+    QCollator m_collator;
+    int m_parallelThreshold = 4096;
+
+    // 布局变化期间保存的代理持久索引及其对应的源索引
+    QModelIndexList m_layoutProxyIndexes;
+    QList<QPersistentModelIndex> m_layoutSourceIndexes;
+};
+
+#endif // LEAFSORTPROXYMODEL_H
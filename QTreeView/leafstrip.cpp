@@ -0,0 +1,105 @@
+#include "leafstrip.h"
+#include <QPainter>
+
+namespace LeafStrip {
+
+int StripLayout::contentWidth() const
+{
+    int width = leafCount * ButtonPitch;
+    if (hasMore)
+        width += ExtraButtonWidth + ButtonSpacing;
+    if (hasCollapse)
+        width += ExtraButtonWidth + ButtonSpacing;
+    return qMax(0, width - ButtonSpacing);
+}
+
+QRect StripLayout::slotRect(int slot) const
+{
+    if (slot < 0 || slot >= slotCount())
+        return QRect();
+    if (slot < leafCount)
+        return buttonRect(origin() + slot * ButtonPitch, clip);
+
+    // "..."在前, 收起按钮在后
+    const int extra = slot - leafCount;
+    return buttonRect(origin() + leafCount * ButtonPitch + extra * (ExtraButtonWidth + ButtonSpacing), clip,
+                      ExtraButtonWidth);
+}
+
+int StripLayout::firstVisibleLeaf() const
+{
+    return qMax(0, offset / ButtonPitch);
+}
+
+int StripLayout::lastVisibleLeaf() const
+{
+    if (clip.width() <= 0)
+        return -1;
+    return qMin(leafCount - 1, (offset + clip.width() - 1) / ButtonPitch);
+}
+
+StripLayout layoutStrip(const QRect &rowRect, int textWidth, int leafCount, bool hasMore, bool hasCollapse,
+                        int offset)
+{
+    StripLayout layout;
+    const int left = startX(rowRect, textWidth);
+    layout.clip = QRect(QPoint(left, rowRect.top()), QPoint(qMax(left - 1, rowRect.right()), rowRect.bottom()));
+    layout.leafCount = leafCount;
+    layout.hasMore = hasMore;
+    layout.hasCollapse = hasCollapse;
+    layout.offset = qBound(0, offset, layout.maxOffset());
+    return layout;
+}
+
+void paintLeafButton(QPainter *painter, const QRect &rect, const QString &text, bool hovered, bool selected)
+{
+    // 绘制叶节点按钮, 选中(多选拖动)时加深底色和边框
+    QColor buttonColor = hovered ? QColor(220, 230, 255) : QColor(230, 230, 230);
+    if (selected)
+        buttonColor = QColor(180, 205, 250);
+    painter->setPen(QPen(selected ? QColor(40, 110, 220) : QColor(Qt::gray)));
+    painter->setBrush(buttonColor);
+    painter->drawRoundedRect(rect, 5, 5);
+
+    // 绘制叶节点文本
+    painter->setPen(Qt::black);
+    painter->drawText(rect, Qt::AlignCenter, text);
+
+    // 如果此叶节点正被悬停，绘制删除按钮(X)
+    if (hovered) {
+        painter->setPen(QPen(Qt::red, 2));
+        QRect xRect = deleteButtonRect(rect);
+        painter->drawLine(xRect.topLeft(), xRect.bottomRight());
+        painter->drawLine(xRect.topRight(), xRect.bottomLeft());
+    }
+}
+
+void paintMoreButton(QPainter *painter, const QRect &rect)
+{
+    painter->setPen(QPen(Qt::gray));
+    painter->setBrush(QColor(200, 200, 200));
+    painter->drawRoundedRect(rect, 5, 5);
+
+    painter->setPen(Qt::black);
+    painter->drawText(rect, Qt::AlignCenter, "...");
+}
+
+void paintCollapseButton(QPainter *painter, const QRect &rect)
+{
+    painter->setPen(QPen(Qt::gray));
+    painter->setBrush(QColor(200, 200, 200));
+    painter->drawRoundedRect(rect, 5, 5);
+
+    painter->setPen(Qt::black);
+    painter->drawText(rect, Qt::AlignCenter, QString(QChar(0x00AB))); // «
+}
+
+void paintFocusFrame(QPainter *painter, const QRect &rect)
+{
+    // 键盘焦点框, 画在按钮外侧 2px
+    painter->setPen(QPen(QColor(40, 110, 220), 2, Qt::DotLine));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRoundedRect(rect.adjusted(-2, -2, 2, 2), 6, 6);
+}
+
+} // namespace LeafStrip
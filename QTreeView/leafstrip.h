@@ -0,0 +1,70 @@
+#ifndef LEAFSTRIP_H
+#define LEAFSTRIP_H
+
+#include <QRect>
+#include <QString>
+
+class QPainter;
+
+// 叶节点按钮条的几何常量与绘制函数
+// 只依赖传入的 QPainter, 不访问模型和控件, 因此也可以在工作线程中绘制到 QImage
+namespace LeafStrip {
+
+const int ButtonWidth = 80;
+const int ButtonHeight = 30;
+const int ButtonSpacing = 5;
+const int DeleteButtonSize = 16;
+const int MaxVisibleLeafs = 2;  // 未翻页时最多显示的叶节点数
+const int ButtonPitch = ButtonWidth + ButtonSpacing;
+const int ExtraButtonWidth = ButtonWidth / 2;  // "..."和收起按钮
+
+// 按钮条起点: 行文本宽度之后再留 40px 余量和 20px 间距
+inline int startX(const QRect &rowRect, int textWidth)
+{
+    return rowRect.left() + textWidth + 40 + 20;
+}
+
+inline QRect buttonRect(int x, const QRect &rowRect, int width = ButtonWidth)
+{
+    return QRect(x, rowRect.center().y() - ButtonHeight / 2, width, ButtonHeight);
+}
+
+inline QRect deleteButtonRect(const QRect &leafRect)
+{
+    return QRect(leafRect.right() - DeleteButtonSize - 2, leafRect.top() + 2,
+                 DeleteButtonSize, DeleteButtonSize);
+}
+
+// 一行按钮条的水平几何: 叶节点按钮等宽, 第 slot 个按钮在 origin() + slot * ButtonPitch,
+// 之后依次是"..."和收起按钮. 按钮条只在 clip 内可见, 水平滚动即整体左移 offset 像素,
+// 因此可见的按钮范围直接由 offset 算出, 不必逐个布局
+struct StripLayout {
+    QRect clip;            // 可见区域: 行文本之后到行矩形右边缘
+    int offset = 0;        // 水平滚动量, 已限制在 [0, maxOffset()]
+    int leafCount = 0;     // 已显示(翻过页)的叶节点按钮数
+    bool hasMore = false;
+    bool hasCollapse = false;
+
+    int origin() const { return clip.left() - offset; }
+    int slotCount() const { return leafCount + (hasMore ? 1 : 0) + (hasCollapse ? 1 : 0); }
+    int contentWidth() const;
+    int maxOffset() const { return qMax(0, contentWidth() - clip.width()); }
+    // 槽位依次为叶节点按钮、"..."按钮和收起按钮(若存在), 越界返回空矩形
+    QRect slotRect(int slot) const;
+    // 与 clip 相交的叶节点按钮 [firstVisibleLeaf, lastVisibleLeaf], 没有时 first > last
+    int firstVisibleLeaf() const;
+    int lastVisibleLeaf() const;
+};
+
+// 代理与图块渲染器共用的布局计算
+StripLayout layoutStrip(const QRect &rowRect, int textWidth, int leafCount, bool hasMore, bool hasCollapse,
+                        int offset);
+
+void paintLeafButton(QPainter *painter, const QRect &rect, const QString &text, bool hovered, bool selected = false);
+void paintMoreButton(QPainter *painter, const QRect &rect);
+void paintCollapseButton(QPainter *painter, const QRect &rect);
+void paintFocusFrame(QPainter *painter, const QRect &rect);
+
+} // namespace LeafStrip
+
+#endif // LEAFSTRIP_H
@@ -0,0 +1,528 @@
+#include "leaftreemodel.h"
+#include "treeroles.h"
+#include <algorithm>
+#include <functional>
+
+LeafTreeModel::LeafTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+LeafTreeModel::~LeafTreeModel()
+{
+    qDeleteAll(m_nodes);
+}
+
+void LeafTreeModel::setHeaderLabel(const QString &label)
+{
+    m_headerLabels[0] = label;
+    emit headerDataChanged(Qt::Horizontal, 0, 0);
+}
+
+void LeafTreeModel::setHeaderLabels(const QStringList &labels)
+{
+    const QStringList newLabels = labels.isEmpty() ? QStringList(QString()) : labels;
+    if (newLabels.size() == m_headerLabels.size()) {
+        m_headerLabels = newLabels;
+        emit headerDataChanged(Qt::Horizontal, 0, m_headerLabels.size() - 1);
+        return;
+    }
+
+    const bool reset = !m_root.children.isEmpty();
+    if (reset)
+        beginResetModel();
+    m_headerLabels = newLabels;
+    if (reset)
+        endResetModel();
+    emit headerDataChanged(Qt::Horizontal, 0, m_headerLabels.size() - 1);
+}
+
+LeafTreeModel::ApplyStats LeafTreeModel::applySnapshot(const Snapshot &snapshot)
+{
+    ApplyStats stats;
+    const quint32 generation = ++m_generation;
+    m_root.generation = generation;
+
+    // 目标结构: 父节点 ID -> 子节点在快照中的下标, 按显示顺序; ID 0 保留给根
+    QHash<quint64, QVector<int>> targetChildren;
+    for (int i = 0; i < snapshot.nodes.size(); ++i) {
+        const Snapshot::Node &node = snapshot.nodes.at(i);
+        if (node.id != 0 && node.id != node.parentId)
+            targetChildren[node.parentId].append(i);
+    }
+
+    QVector<Node *> changedNodes;
+    auto updateNode = [&](Node *node, const Snapshot::Node &target) {
+        node->generation = generation;
+        if (node->text == target.text && node->checkable == target.checkable
+                && (!target.checkable || node->checkState == target.checkState) && node->value == target.value)
+            return;
+        node->text = target.text;
+        node->checkable = target.checkable;
+        node->checkState = target.checkState;
+        node->value = target.value;
+        changedNodes.append(node);
+    };
+
+    // 自顶向下逐个父节点放置目标子节点: 处理某个父节点时, 它自身已经在最终位置上,
+    // 行号小于当前下标的子节点也已就位, 因此需要的节点只会从后面或其他父节点移入, 不会形成环
+    QVector<quint64> queue { 0 };
+    for (int q = 0; q < queue.size(); ++q) {
+        const quint64 parentId = queue.at(q);
+        const auto childrenIt = targetChildren.constFind(parentId);
+        if (childrenIt == targetChildren.constEnd())
+            continue;
+
+        Node *parentNode = parentId == 0 ? &m_root : m_nodes.value(parentId);
+        const QVector<int> &targets = childrenIt.value();
+        int i = 0;
+        while (i < targets.size()) {
+            const Snapshot::Node &target = snapshot.nodes.at(targets.at(i));
+            Node *node = m_nodes.value(target.id);
+
+            if (!node) {
+                // 连续的新节点连同其新子树一次插入
+                int end = i + 1;
+                while (end < targets.size() && !m_nodes.contains(snapshot.nodes.at(targets.at(end)).id))
+                    ++end;
+
+                beginInsertRows(indexFor(parentNode), i, end - 1);
+                parentNode->children.insert(i, end - i, nullptr);
+                for (int j = i; j < end; ++j) {
+                    Node *created = createSubtree(snapshot, targets.at(j), targetChildren, stats);
+                    created->parent = parentNode;
+                    parentNode->children[j] = created;
+                    // 只排入新子树的根; 子树中的节点在其父节点被处理时已就位, 由就位分支排入
+                    queue.append(created->id);
+                }
+                renumber(parentNode, i);
+                endInsertRows();
+                ++stats.insertSignals;
+                i = end;
+                continue;
+            }
+
+            if (node->parent == parentNode && node->row == i) {
+                updateNode(node, target);
+                queue.append(target.id);
+                ++i;
+                continue;
+            }
+
+            // 已存在但不在目标位置: 源位置连续的一段一次移动
+            Node *sourceParent = node->parent;
+            const int sourceRow = node->row;
+            int end = i + 1;
+            while (end < targets.size()) {
+                const Node *next = m_nodes.value(snapshot.nodes.at(targets.at(end)).id);
+                if (!next || next->parent != sourceParent || next->row != sourceRow + (end - i))
+                    break;
+                ++end;
+            }
+            const int count = end - i;
+
+            // 同一父节点内只会向上移(行号小于 i 的都已就位), 移出后目标位置仍是 i
+            beginMoveRows(indexFor(sourceParent), sourceRow, sourceRow + count - 1, indexFor(parentNode), i);
+            relinkRows(sourceParent, sourceRow, count, parentNode, i);
+            endMoveRows();
+            ++stats.moveSignals;
+            stats.moved += count;
+
+            for (int j = i; j < end; ++j) {
+                const Snapshot::Node &moved = snapshot.nodes.at(targets.at(j));
+                updateNode(m_nodes.value(moved.id), moved);
+                queue.append(moved.id);
+            }
+            i = end;
+        }
+    }
+
+    // 没有就位的节点都不在快照中. 此时它们只会出现在各父节点的目标子节点之后,
+    // 只删除父节点已就位的最上层节点, 同一父节点中连续的行一次删除
+    QVector<Node *> removedRoots;
+    for (Node *node : std::as_const(m_nodes)) {
+        if (node->generation != generation && node->parent->generation == generation)
+            removedRoots.append(node);
+    }
+    std::sort(removedRoots.begin(), removedRoots.end(), [](const Node *a, const Node *b) {
+        return a->parent != b->parent ? std::less<const Node *>()(a->parent, b->parent) : a->row > b->row;
+    });
+    for (int i = 0; i < removedRoots.size();) {
+        Node *parentNode = removedRoots.at(i)->parent;
+        const int last = removedRoots.at(i)->row;
+        int end = i + 1;
+        while (end < removedRoots.size() && removedRoots.at(end)->parent == parentNode
+               && removedRoots.at(end)->row == last - (end - i))
+            ++end;
+        const int first = last - (end - i) + 1;
+
+        const int before = m_nodes.size();
+        beginRemoveRows(indexFor(parentNode), first, last);
+        for (int row = first; row <= last; ++row)
+            deleteSubtree(parentNode->children.at(row));
+        parentNode->children.remove(first, last - first + 1);
+        renumber(parentNode, first);
+        endRemoveRows();
+        ++stats.removeSignals;
+        stats.removed += before - m_nodes.size();
+        i = end;
+    }
+
+    // 数据变化按父节点合并成连续行范围
+    stats.changed = changedNodes.size();
+    stats.dataChangedSignals = emitMergedDataChanged(changedNodes,
+                                                     { Qt::DisplayRole, Qt::EditRole, Qt::CheckStateRole, NodeValueRole });
+
+    return stats;
+}
+
+LeafTreeModel::BatchStats LeafTreeModel::setDataBatch(const QVector<DataUpdate> &updates)
+{
+    BatchStats stats;
+    QVector<Node *> changedNodes;
+    QVector<int> roles;
+    for (const DataUpdate &update : updates) {
+        Node *node = m_nodes.value(update.id);
+        if (!node) {
+            ++stats.unresolved;
+            continue;
+        }
+        bool changed = false;
+        if (!assignData(node, update.value, update.role, &changed))
+            continue;
+        ++stats.applied;
+        if (!changed)
+            continue;
+
+        changedNodes.append(node);
+        for (int role : changedRoles(update.role)) {
+            if (!roles.contains(role))
+                roles.append(role);
+        }
+    }
+
+    // 同一节点的多个角色只算一行
+    std::sort(changedNodes.begin(), changedNodes.end());
+    changedNodes.erase(std::unique(changedNodes.begin(), changedNodes.end()), changedNodes.end());
+    stats.dataChangedSignals = emitMergedDataChanged(changedNodes, roles);
+    return stats;
+}
+
+int LeafTreeModel::emitMergedDataChanged(QVector<Node *> &nodes, const QVector<int> &roles)
+{
+    std::sort(nodes.begin(), nodes.end(), [](const Node *a, const Node *b) {
+        return a->parent != b->parent ? std::less<const Node *>()(a->parent, b->parent) : a->row < b->row;
+    });
+    int signalCount = 0;
+    for (int i = 0; i < nodes.size();) {
+        Node *first = nodes.at(i);
+        int end = i + 1;
+        while (end < nodes.size() && nodes.at(end)->parent == first->parent
+               && nodes.at(end)->row == first->row + (end - i))
+            ++end;
+        emit dataChanged(indexFor(first), indexFor(nodes.at(end - 1)), roles);
+        ++signalCount;
+        i = end;
+    }
+    return signalCount;
+}
+
+LeafTreeModel::Node *LeafTreeModel::createSubtree(const Snapshot &snapshot, int position,
+                                                  const QHash<quint64, QVector<int>> &targetChildren,
+                                                  ApplyStats &stats)
+{
+    const Snapshot::Node &source = snapshot.nodes.at(position);
+    Node *node = new Node;
+    node->id = source.id;
+    node->text = source.text;
+    node->checkable = source.checkable;
+    node->checkState = source.checkState;
+    node->value = source.value;
+    node->generation = m_generation;
+    m_nodes.insert(node->id, node);
+    ++stats.inserted;
+
+    // 已存在于模型中的子节点留给该节点被处理时移入
+    const auto childrenIt = targetChildren.constFind(node->id);
+    if (childrenIt != targetChildren.constEnd()) {
+        for (int childPosition : childrenIt.value()) {
+            if (m_nodes.contains(snapshot.nodes.at(childPosition).id))
+                continue;
+            Node *child = createSubtree(snapshot, childPosition, targetChildren, stats);
+            child->parent = node;
+            child->row = node->children.size();
+            node->children.append(child);
+        }
+    }
+    return node;
+}
+
+LeafTreeModel::Snapshot LeafTreeModel::snapshot() const
+{
+    Snapshot result;
+    result.nodes.reserve(m_nodes.size());
+
+    // 先序遍历, 用显式栈避免深树递归
+    QVector<const Node *> stack;
+    for (int row = m_root.children.size() - 1; row >= 0; --row)
+        stack.append(m_root.children.at(row));
+    while (!stack.isEmpty()) {
+        const Node *node = stack.takeLast();
+        Snapshot::Node entry;
+        entry.id = node->id;
+        entry.parentId = node->parent->id;
+        entry.text = node->text;
+        entry.checkable = node->checkable;
+        entry.checkState = node->checkState;
+        entry.value = node->value;
+        result.nodes.append(entry);
+        for (int row = node->children.size() - 1; row >= 0; --row)
+            stack.append(node->children.at(row));
+    }
+    return result;
+}
+
+QModelIndex LeafTreeModel::indexForId(quint64 id) const
+{
+    Node *node = m_nodes.value(id);
+    return node ? indexFor(node) : QModelIndex();
+}
+
+QModelIndex LeafTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const Node *parentNode = nodeFor(parent);
+    if (column < 0 || column >= m_headerLabels.size() || row < 0 || row >= parentNode->children.size())
+        return QModelIndex();
+    return createIndex(row, column, parentNode->children.at(row));
+}
+
+QModelIndex LeafTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid())
+        return QModelIndex();
+    return indexFor(nodeFor(child)->parent);
+}
+
+int LeafTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return 0;
+    return nodeFor(parent)->children.size();
+}
+
+int LeafTreeModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return m_headerLabels.size();
+}
+
+bool LeafTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    return parent.column() <= 0 && !nodeFor(parent)->children.isEmpty();
+}
+
+QVariant LeafTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Node *node = nodeFor(index);
+    // 附加列只标识节点
+    if (index.column() > 0)
+        return role == NodeIdRole ? QVariant::fromValue<quint64>(node->id) : QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return node->text;
+    case Qt::CheckStateRole:
+        return node->checkable ? QVariant(int(node->checkState)) : QVariant();
+    case NodeValueRole:
+        return node->value;
+    case HasChildrenRole:
+        return !node->children.isEmpty();
+    case NodeIdRole:
+        return QVariant::fromValue<quint64>(node->id);
+    default:
+        return QVariant();
+    }
+}
+
+bool LeafTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.column() > 0)
+        return false;
+
+    bool changed = false;
+    if (!assignData(nodeFor(index), value, role, &changed))
+        return false;
+    if (changed)
+        emit dataChanged(index, index, changedRoles(role));
+    return true;
+}
+
+bool LeafTreeModel::assignData(Node *node, const QVariant &value, int role, bool *changed)
+{
+    *changed = false;
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        if (node->text != value.toString()) {
+            node->text = value.toString();
+            *changed = true;
+        }
+        return true;
+    case Qt::CheckStateRole:
+        if (!node->checkable)
+            return false;
+        if (node->checkState != Qt::CheckState(value.toInt())) {
+            node->checkState = Qt::CheckState(value.toInt());
+            *changed = true;
+        }
+        return true;
+    case NodeValueRole: {
+        bool ok = false;
+        const double number = value.toDouble(&ok);
+        if (!ok)
+            return false;
+        if (node->value != number) {
+            node->value = number;
+            *changed = true;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+QVector<int> LeafTreeModel::changedRoles(int role)
+{
+    // 文本同时作为显示和编辑角色
+    if (role == Qt::DisplayRole || role == Qt::EditRole)
+        return { Qt::DisplayRole, Qt::EditRole };
+    return { role };
+}
+
+Qt::ItemFlags LeafTreeModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+
+    Qt::ItemFlags itemFlags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() == 0 && nodeFor(index)->checkable)
+        itemFlags |= Qt::ItemIsUserCheckable;
+    return itemFlags;
+}
+
+QVariant LeafTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section >= 0 && section < m_headerLabels.size() && orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return m_headerLabels.at(section);
+    return QVariant();
+}
+
+bool LeafTreeModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    Node *parentNode = nodeFor(parent);
+    if (row < 0 || count <= 0 || row + count > parentNode->children.size() || parent.column() > 0)
+        return false;
+
+    beginRemoveRows(parent, row, row + count - 1);
+    for (int i = row; i < row + count; ++i)
+        deleteSubtree(parentNode->children.at(i));
+    parentNode->children.remove(row, count);
+    renumber(parentNode, row);
+    endRemoveRows();
+    return true;
+}
+
+bool LeafTreeModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                             const QModelIndex &destinationParent, int destinationChild)
+{
+    Node *from = nodeFor(sourceParent);
+    Node *to = nodeFor(destinationParent);
+    if (sourceParent.column() > 0 || destinationParent.column() > 0 || count <= 0 || sourceRow < 0
+            || sourceRow + count > from->children.size()
+            || destinationChild < 0 || destinationChild > to->children.size())
+        return false;
+
+    // beginMoveRows 拒绝原地移动和移入自身子树的情况
+    if (!beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1, destinationParent, destinationChild))
+        return false;
+
+    // destinationChild 按移动前的行号计; 同一父节点内向下移时, 移出后目标位置前移 count 行
+    const int insertAt = from == to && destinationChild > sourceRow ? destinationChild - count : destinationChild;
+    relinkRows(from, sourceRow, count, to, insertAt);
+    endMoveRows();
+    return true;
+}
+
+void LeafTreeModel::reportMemory(MemoryReport &report) const
+{
+    const QString subsystem = objectName().isEmpty()
+            ? QString("LeafTreeModel") : QString("LeafTreeModel(%1)").arg(objectName());
+
+    quint64 childVectors = 0;
+    quint64 childVectorBytes = 0;
+    quint64 textBytes = 0;
+    for (const Node *node : std::as_const(m_nodes)) {
+        textBytes += MemoryReport::stringBytes(node->text);
+        if (node->children.capacity() > 0) {
+            ++childVectors;
+            childVectorBytes += 16 + quint64(node->children.capacity()) * sizeof(Node *);
+        }
+    }
+
+    const quint64 nodes = m_nodes.size();
+    report.add(subsystem, "nodes", nodes * (sizeof(Node) + 16), nodes);
+    report.add(subsystem, "id index", nodes * MemoryReport::hashNodeBytes(sizeof(quint64), sizeof(Node *)), nodes);
+    report.add(subsystem, "text", textBytes, 0);
+    report.add(subsystem, "child vectors", childVectorBytes, childVectors);
+}
+
+LeafTreeModel::Node *LeafTreeModel::nodeFor(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return const_cast<Node *>(&m_root);
+    return static_cast<Node *>(index.internalPointer());
+}
+
+QModelIndex LeafTreeModel::indexFor(Node *node) const
+{
+    if (!node || node == &m_root)
+        return QModelIndex();
+    return createIndex(node->row, 0, node);
+}
+
+void LeafTreeModel::renumber(Node *parent, int from)
+{
+    for (int row = from; row < parent->children.size(); ++row)
+        parent->children.at(row)->row = row;
+}
+
+void LeafTreeModel::relinkRows(Node *from, int sourceRow, int count, Node *to, int insertAt)
+{
+    const QVector<Node *> moving = from->children.mid(sourceRow, count);
+    from->children.remove(sourceRow, count);
+    to->children.insert(insertAt, count, nullptr);
+    for (int j = 0; j < count; ++j) {
+        moving.at(j)->parent = to;
+        to->children[insertAt + j] = moving.at(j);
+    }
+
+    if (from == to) {
+        renumber(to, qMin(sourceRow, insertAt));
+    } else {
+        renumber(from, sourceRow);
+        renumber(to, insertAt);
+    }
+}
+
+void LeafTreeModel::deleteSubtree(Node *node)
+{
+    for (Node *child : std::as_const(node->children))
+        deleteSubtree(child);
+    m_nodes.remove(node->id);
+    delete node;
+}
@@ -0,0 +1,129 @@
+#ifndef LEAFTREEMODEL_H
+#define LEAFTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include "memoryreport.h"
+
+// 以稳定节点 ID(NodeIdRole)为键的树模型. 第 0 列是节点文本、复选状态和数值(NodeValueRole), 其余列由表头标签数决定,
+// 只提供 NodeIdRole, 内容由视图中该列的代理按节点 ID 自行取得(例如子树汇总)
+// applySnapshot() 把新的层级快照与当前内容按 ID 比对, 只发出必要的
+// 插入、删除、移动和 dataChanged, 视图的展开状态、代理的持久索引和滚动位置都得以保留
+class LeafTreeModel : public QAbstractItemModel, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    // 层级快照: 同一父节点的子节点按显示顺序出现, 父节点可以出现在子节点之后;
+    // ID 必须唯一且不为 0, parentId 为 0 表示顶层. 无法沿父链到达顶层的节点视为不存在
+    struct Snapshot {
+        struct Node {
+            quint64 id = 0;
+            quint64 parentId = 0;
+            QString text;
+            bool checkable = false;
+            Qt::CheckState checkState = Qt::Unchecked;
+            double value = 0.0;
+        };
+        QVector<Node> nodes;
+    };
+
+    // 一次 applySnapshot 发出的结构与数据变化
+    struct ApplyStats {
+        int inserted = 0;        // 新增节点数(含新子树中的节点)
+        int removed = 0;         // 删除节点数(含子树)
+        int moved = 0;           // 移动的行数
+        int changed = 0;         // 文本、复选状态或数值变化的节点数
+        int insertSignals = 0;
+        int removeSignals = 0;
+        int moveSignals = 0;
+        int dataChangedSignals = 0;
+    };
+
+    // 按节点 ID 寻址的一次数据写入, 角色与 setData 相同
+    struct DataUpdate {
+        quint64 id = 0;
+        int role = Qt::EditRole;
+        QVariant value;
+    };
+
+    // 一次 setDataBatch 的结果
+    struct BatchStats {
+        int applied = 0;         // 写入成功(含值未变)的更新数
+        int unresolved = 0;      // 节点 ID 不存在
+        int dataChangedSignals = 0;
+    };
+
+    explicit LeafTreeModel(QObject *parent = nullptr);
+    ~LeafTreeModel() override;
+
+    void setHeaderLabel(const QString &label);
+    // 每列一个标签, 列数随之改变(至少 1 列); 已有内容时改变列数会重置模型
+    void setHeaderLabels(const QStringList &labels);
+
+    ApplyStats applySnapshot(const Snapshot &snapshot);
+    // 按先序导出当前内容
+    Snapshot snapshot() const;
+
+    QModelIndex indexForId(quint64 id) const;
+
+    // 依次应用一批更新, 不逐项发信号; 值确实改变的节点按父节点合并成连续行范围, 每段一个 dataChanged
+    BatchStats setDataBatch(const QVector<DataUpdate> &updates);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    // 节点对象原样挂到新父节点下, ID、子树和指向它们的持久索引都保持不变
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override;
+
+    void reportMemory(MemoryReport &report) const override;
+
+private:
+    struct Node {
+        quint64 id = 0;
+        QString text;
+        bool checkable = false;
+        Qt::CheckState checkState = Qt::Unchecked;
+        double value = 0.0;
+        Node *parent = nullptr;
+        int row = 0;                 // 在父节点 children 中的位置
+        quint32 generation = 0;      // 最近一次 applySnapshot 中已就位的标记
+        QVector<Node *> children;
+    };
+
+    Node *createSubtree(const Snapshot &snapshot, int position, const QHash<quint64, QVector<int>> &targetChildren,
+                        ApplyStats &stats);
+
+    // 写入一个角色, 不发信号; 节点不接受该角色时返回 false
+    static bool assignData(Node *node, const QVariant &value, int role, bool *changed);
+    // 写入 role 后 dataChanged 应携带的角色
+    static QVector<int> changedRoles(int role);
+    // nodes 排序后按父节点把连续的行合并, 每段发出一个 dataChanged, 返回信号数
+    int emitMergedDataChanged(QVector<Node *> &nodes, const QVector<int> &roles);
+
+    Node *nodeFor(const QModelIndex &index) const;
+    QModelIndex indexFor(Node *node) const;
+    static void renumber(Node *parent, int from);
+    // 把 from 的 [sourceRow, sourceRow+count) 挂到 to 的 insertAt 处(按移出之后的行号)
+    static void relinkRows(Node *from, int sourceRow, int count, Node *to, int insertAt);
+    void deleteSubtree(Node *node);
+
+    Node m_root;
+    quint32 m_generation = 0;
+    QHash<quint64, Node *> m_nodes;
+    QStringList m_headerLabels = { QString() };
+};
+
+#endif // LEAFTREEMODEL_H
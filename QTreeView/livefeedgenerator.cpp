@@ -0,0 +1,130 @@
+#include "livefeedgenerator.h"
+#include "treeroles.h"
+#include <QAbstractItemModel>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QThread>
+#include <utility>
+
+namespace {
+
+void collectSubtree(const QAbstractItemModel *model, const QModelIndex &parent,
+                    QVector<quint64> *labelNodes, QVector<quint64> *checkNodes)
+{
+    const int rows = model->rowCount(parent);
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        const QVariant id = index.data(NodeIdRole);
+        const bool hasChildren = model->hasChildren(index);
+        if (id.isValid()) {
+            if (!hasChildren && parent.isValid())
+                labelNodes->append(id.toULongLong());
+            else if (index.data(Qt::CheckStateRole).isValid())
+                checkNodes->append(id.toULongLong());
+        }
+        if (hasChildren)
+            collectSubtree(model, index, labelNodes, checkNodes);
+    }
+}
+
+} // namespace
+
+LiveFeedGenerator::LiveFeedGenerator(Sink sink, QObject *parent)
+    : QObject(parent)
+    , m_sink(std::move(sink))
+{
+}
+
+LiveFeedGenerator::~LiveFeedGenerator()
+{
+    stop();
+}
+
+void LiveFeedGenerator::setTargets(const QVector<quint64> &labelNodes, const QVector<quint64> &checkNodes)
+{
+    m_labelNodes = labelNodes;
+    m_checkNodes = checkNodes;
+}
+
+void LiveFeedGenerator::collectTargets(const QAbstractItemModel *model,
+                                       QVector<quint64> *labelNodes, QVector<quint64> *checkNodes)
+{
+    collectSubtree(model, QModelIndex(), labelNodes, checkNodes);
+}
+
+void LiveFeedGenerator::start(int updatesPerSecond, int threadCount, quint64 totalUpdates)
+{
+    stop();
+    if (m_labelNodes.isEmpty() && m_checkNodes.isEmpty())
+        return;
+
+    threadCount = qMax(1, threadCount);
+    m_generated.store(0, std::memory_order_relaxed);
+    m_running.store(true);
+
+    const double perThreadRate = double(qMax(1, updatesPerSecond)) / threadCount;
+    for (int i = 0; i < threadCount; ++i) {
+        // 总量平均分给各线程, 余数给前几个线程
+        quint64 quota = 0;
+        if (totalUpdates > 0)
+            quota = totalUpdates / threadCount + (quint64(i) < totalUpdates % threadCount ? 1 : 0);
+
+        QThread *thread = QThread::create([this, i, perThreadRate, quota]{
+            produce(i, perThreadRate, quota);
+        });
+        m_threads.append(thread);
+        thread->start();
+    }
+}
+
+void LiveFeedGenerator::stop()
+{
+    m_running.store(false);
+    for (QThread *thread : std::as_const(m_threads)) {
+        thread->wait();
+        delete thread;
+    }
+    m_threads.clear();
+}
+
+bool LiveFeedGenerator::isRunning() const
+{
+    if (!m_running.load())
+        return false;
+    for (const QThread *thread : m_threads) {
+        if (thread->isRunning())
+            return true;
+    }
+    return false;
+}
+
+void LiveFeedGenerator::produce(int threadIndex, double updatesPerSecond, quint64 quota)
+{
+    QRandomGenerator random(quint32(0x5eed + threadIndex));
+    QElapsedTimer clock;
+    clock.start();
+
+    // 按经过的时间补足应产生的更新数, 每批之间让出约 1ms
+    quint64 produced = 0;
+    while (m_running.load(std::memory_order_relaxed) && (quota == 0 || produced < quota)) {
+        quint64 due = quint64(clock.nsecsElapsed() / 1e9 * updatesPerSecond);
+        if (quota > 0)
+            due = qMin(due, quota);
+
+        for (; produced < due; ++produced) {
+            // 约四分之一的更新是复选状态, 其余是叶节点文本
+            const bool checkUpdate = !m_checkNodes.isEmpty()
+                    && (m_labelNodes.isEmpty() || random.bounded(4) == 0);
+            if (checkUpdate) {
+                const quint64 nodeId = m_checkNodes.at(random.bounded(int(m_checkNodes.size())));
+                const Qt::CheckState state = random.bounded(2) ? Qt::Checked : Qt::Unchecked;
+                m_sink(nodeId, Qt::CheckStateRole, int(state));
+            } else {
+                const quint64 nodeId = m_labelNodes.at(random.bounded(int(m_labelNodes.size())));
+                m_sink(nodeId, Qt::DisplayRole, QString("Leaf #%1 (%2)").arg(nodeId).arg(random.bounded(1000)));
+            }
+            m_generated.fetch_add(1, std::memory_order_relaxed);
+        }
+        QThread::usleep(1000);
+    }
+}
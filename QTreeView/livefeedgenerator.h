@@ -0,0 +1,50 @@
+#ifndef LIVEFEEDGENERATOR_H
+#define LIVEFEEDGENERATOR_H
+
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+class QAbstractItemModel;
+class QThread;
+
+// 本地合成数据源: 在若干工作线程中以固定速率产生叶节点文本和复选状态的更新
+// 更新交给 Sink 处理, 通常是 LiveUpdateQueue::post
+class LiveFeedGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(quint64 nodeId, int role, const QVariant &value)> Sink;
+
+    explicit LiveFeedGenerator(Sink sink, QObject *parent = nullptr);
+    ~LiveFeedGenerator() override;
+
+    // 文本更新的目标(叶节点)与复选状态更新的目标(可勾选的子节点)
+    void setTargets(const QVector<quint64> &labelNodes, const QVector<quint64> &checkNodes);
+
+    // 从模型中按 NodeIdRole 收集目标节点
+    static void collectTargets(const QAbstractItemModel *model,
+                               QVector<quint64> *labelNodes, QVector<quint64> *checkNodes);
+
+    // totalUpdates > 0 时产生这么多更新后自动停止
+    void start(int updatesPerSecond, int threadCount = 1, quint64 totalUpdates = 0);
+    void stop();
+    bool isRunning() const;
+
+    quint64 generated() const { return m_generated.load(std::memory_order_relaxed); }
+
+private:
+    void produce(int threadIndex, double updatesPerSecond, quint64 quota);
+
+    Sink m_sink;
+    QVector<quint64> m_labelNodes;
+    QVector<quint64> m_checkNodes;
+    QVector<QThread *> m_threads;
+    std::atomic<bool> m_running { false };
+    std::atomic<quint64> m_generated { 0 };
+};
+
+#endif // LIVEFEEDGENERATOR_H
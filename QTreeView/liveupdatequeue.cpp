@@ -0,0 +1,129 @@
+#include "liveupdatequeue.h"
+#include "leaftreemodel.h"
+#include "perfcounters.h"
+#include <QHash>
+#include <QPair>
+
+LiveUpdateQueue::LiveUpdateQueue(LeafTreeModel *model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &LiveUpdateQueue::applyPending);
+}
+
+LiveUpdateQueue::~LiveUpdateQueue()
+{
+}
+
+void LiveUpdateQueue::post(quint64 nodeId, int role, const QVariant &value)
+{
+    LiveUpdate update;
+    update.nodeId = nodeId;
+    update.role = role;
+    update.value = value;
+    update.postedNs = Perf::nowNs();
+    m_queue.push(std::move(update));
+    m_posted.fetch_add(1, std::memory_order_relaxed);
+
+    // 入队之后再检查标记: 消费者先清标记再取队列, 因此不会漏掉这次更新
+    if (!m_scheduled.exchange(true))
+        QMetaObject::invokeMethod(this, [this]{ scheduleFrame(); }, Qt::QueuedConnection);
+}
+
+void LiveUpdateQueue::setFrameInterval(int msec)
+{
+    m_frameInterval = qMax(0, msec);
+}
+
+int LiveUpdateQueue::frameInterval() const
+{
+    return m_frameInterval;
+}
+
+void LiveUpdateQueue::flush()
+{
+    m_frameTimer.stop();
+    applyPending();
+}
+
+LiveUpdateQueue::Stats LiveUpdateQueue::stats() const
+{
+    Stats stats = m_stats;
+    stats.posted = m_posted.load(std::memory_order_relaxed);
+    stats.meanLatencyMs = m_latencySamples ? m_latencySumMs / m_latencySamples : 0.0;
+    return stats;
+}
+
+void LiveUpdateQueue::resetStats()
+{
+    m_posted.store(0, std::memory_order_relaxed);
+    m_stats = Stats();
+    m_latencySumMs = 0.0;
+    m_latencySamples = 0;
+}
+
+void LiveUpdateQueue::scheduleFrame()
+{
+    if (m_frameTimer.isActive())
+        return;
+
+    // 距上一次应用不足一帧时等到下一帧边界
+    qint64 wait = 0;
+    if (m_sinceLastFrame.isValid())
+        wait = qMax<qint64>(0, m_frameInterval - m_sinceLastFrame.elapsed());
+    m_frameTimer.start(int(wait));
+}
+
+void LiveUpdateQueue::applyPending()
+{
+    m_scheduled.store(false);
+    m_sinceLastFrame.start();
+
+    if (!m_model)
+        return;
+
+    // 合并: 同一节点同一角色只保留最后一次的值; 被覆盖的更新同样计入延迟统计
+    typedef QPair<quint64, int> UpdateKey;
+    QHash<UpdateKey, QVariant> latest;
+    QVector<quint64> postedNs;
+    LiveUpdate update;
+    while (m_queue.pop(update)) {
+        postedNs.append(update.postedNs);
+        auto it = latest.find(qMakePair(update.nodeId, update.role));
+        if (it != latest.end()) {
+            it.value() = std::move(update.value);
+            ++m_stats.merged;
+        } else {
+            latest.insert(qMakePair(update.nodeId, update.role), std::move(update.value));
+        }
+    }
+    if (latest.isEmpty())
+        return;
+
+    QVector<LeafTreeModel::DataUpdate> updates;
+    updates.reserve(latest.size());
+    for (auto it = latest.constBegin(); it != latest.constEnd(); ++it) {
+        LeafTreeModel::DataUpdate dataUpdate;
+        dataUpdate.id = it.key().first;
+        dataUpdate.role = it.key().second;
+        dataUpdate.value = it.value();
+        updates.append(dataUpdate);
+    }
+    const LeafTreeModel::BatchStats batch = m_model->setDataBatch(updates);
+    m_stats.applied += batch.applied;
+    m_stats.unresolved += batch.unresolved;
+    m_stats.dataChangedSignals += batch.dataChangedSignals;
+
+    const quint64 now = Perf::nowNs();
+    for (quint64 posted : postedNs) {
+        const double latencyMs = (now - posted) / 1e6;
+        m_latencySumMs += latencyMs;
+        m_stats.maxLatencyMs = qMax(m_stats.maxLatencyMs, latencyMs);
+    }
+    m_latencySamples += postedNs.size();
+    ++m_stats.frames;
+
+    emit frameApplied(latest.size());
+}
@@ -0,0 +1,77 @@
+#ifndef LIVEUPDATEQUEUE_H
+#define LIVEUPDATEQUEUE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+#include <QVariant>
+#include <atomic>
+#include "mpscqueue.h"
+
+class LeafTreeModel;
+
+// 实时数据更新管线: 任意线程通过 post() 投递按节点 ID(NodeIdRole)寻址的更新,
+// GUI 线程每帧最多应用一次, 同一节点同一角色只保留最后的值, 整批交给
+// LeafTreeModel::setDataBatch, 由模型按父节点把连续的行合并成一个范围 dataChanged
+class LiveUpdateQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats {
+        quint64 posted = 0;
+        quint64 applied = 0;             // 实际写入模型的更新(合并后)
+        quint64 merged = 0;              // 被同帧内更晚的更新覆盖
+        quint64 unresolved = 0;          // 节点 ID 已不存在
+        quint64 dataChangedSignals = 0;
+        quint64 frames = 0;
+        double meanLatencyMs = 0.0;      // 从 post 到 dataChanged 发出
+        double maxLatencyMs = 0.0;
+    };
+
+    explicit LiveUpdateQueue(LeafTreeModel *model, QObject *parent = nullptr);
+    ~LiveUpdateQueue() override;
+
+    // 线程安全
+    void post(quint64 nodeId, int role, const QVariant &value);
+
+    // 两次应用之间的最小间隔, 默认 16ms(约 60 帧)
+    void setFrameInterval(int msec);
+    int frameInterval() const;
+
+    // 立即应用所有已到达的更新(GUI 线程)
+    void flush();
+
+    Stats stats() const;
+    void resetStats();
+
+signals:
+    void frameApplied(int updates);
+
+private:
+    struct LiveUpdate {
+        quint64 nodeId = 0;
+        int role = Qt::DisplayRole;
+        QVariant value;
+        quint64 postedNs = 0;
+    };
+
+    void scheduleFrame();
+    void applyPending();
+
+    QPointer<LeafTreeModel> m_model;
+    MpscQueue<LiveUpdate> m_queue;
+    std::atomic<bool> m_scheduled { false };
+    std::atomic<quint64> m_posted { 0 };
+
+    QTimer m_frameTimer;
+    QElapsedTimer m_sinceLastFrame;
+    int m_frameInterval = 16;
+
+    Stats m_stats;
+    double m_latencySumMs = 0.0;
+    quint64 m_latencySamples = 0;
+};
+
+#endif // LIVEUPDATEQUEUE_H
@@ -1,11 +1,25 @@
 #include "mainwindow.h"
+#include "startupprofiler.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // 启动各阶段计时, STARTUP_PROFILE=1 时退出前输出
+    StartupProfiler::start();
     QApplication a(argc, argv);
+    StartupProfiler::applicationCreated();
+
     MainWindow w;
+    StartupProfiler::mark("window constructed");
+    StartupProfiler::markFirstPaint(&w);
     w.show();
+    StartupProfiler::mark("first layout");
+
+    // 深链接: 第一个参数为节点路径时直接跳转, 例如 QTreeView "Root 1 > Child 1-2 > Leaf 1-2-3"
+    const QStringList arguments = QApplication::arguments();
+    if (arguments.size() > 1 && !w.goToPath(arguments.at(1)))
+        qWarning() << "Path not found:" << arguments.at(1);
+
     return a.exec();
 }
@@ -1,8 +1,42 @@
 #include "mainwindow.h"
 #include "leafbuttondelegate.h"
+#include "leaftreemodel.h"
 #include <QVBoxLayout>
-#include <QStandardItemModel>
+#include <QAbstractProxyModel>
 #include <QMessageBox>
+#include <QShortcut>
+#include <QInputDialog>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QDir>
+#include <QHeaderView>
+#include "perfoverlay.h"
+#include "modelprofiler.h"
+#include "leafsortproxymodel.h"
+#include "rowtilerenderer.h"
+#include "liveupdatequeue.h"
+#include "livefeedgenerator.h"
+#include "treeroles.h"
+#include "treeviewstate.h"
+#include "memoryreport.h"
+#include "subtreeaggregates.h"
+#include "summarydelegate.h"
+#include "startupprofiler.h"
+#include "sessionrecorder.h"
+#include <QSettings>
+
+namespace {
+
+// 共享模型中每棵树的根节点数: Tree A 显示前三个, Tree B 显示后三个
+const int RootsPerTree = 3;
+
+// 录制或回放交互时两棵树都从全部展开开始, 不读写上次保存的视图状态, 否则同一段录制在不同机器上回放的起点不同
+bool useSavedViewState()
+{
+    return !qEnvironmentVariableIsSet("LEAFTREE_RECORD_SESSION") && !qEnvironmentVariableIsSet("LEAFTREE_NO_VIEW_STATE");
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -17,6 +51,10 @@ MainWindow::MainWindow(QWidget *parent)
     connect(leafDelegate, &LeafButtonDelegate::leafClicked, this, &MainWindow::onLeafClicked);
     connect(leafDelegate, &LeafButtonDelegate::leafDeleted, this, &MainWindow::onLeafDeleted);
 
+    // LEAFTREE_TILE_RENDERING=1 时由工作线程预渲染行图块
+    if (qEnvironmentVariableIsSet("LEAFTREE_TILE_RENDERING"))
+        leafDelegate->setTileRenderer(new RowTileRenderer(this));
+
     // Tree1 设置
     tree1 = createTreeView("Tree A");
     tree1->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -33,54 +71,212 @@ MainWindow::MainWindow(QWidget *parent)
     layout->addWidget(tree2);
     layout->addStretch(); // 添加拉伸保证间隔不变
 
-    setupModel(tree1);
-    setupModel(tree2);
-    connectSignals();
+    setupGoToShortcut();
+    setupMemoryReportShortcut();
 
     setCentralWidget(central);
     resize(400, 500); // 固定窗口高度
+
+    // LEAFTREE_DEFERRED_STARTUP=1 时先显示窗口外壳, 第一帧之后再建立两棵树的模型
+    if (qEnvironmentVariableIsSet("LEAFTREE_DEFERRED_STARTUP"))
+        StartupProfiler::afterFirstPaint(this, [this]{ buildModels(); });
+    else
+        buildModels();
+
+#ifdef LEAFTREE_PERF_COUNTERS
+    setupPerfHotkeys();
+#endif
+
+    // LEAFTREE_RECORD_SESSION=<文件> 时录制本窗口(及其对话框)收到的输入, 退出时写出, 供 sessionreplay 回放
+    if (qEnvironmentVariableIsSet("LEAFTREE_RECORD_SESSION")) {
+        sessionRecorder = new SessionRecorder(this, this);
+        sessionRecorder->start();
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    if (sessionRecorder) {
+        sessionRecorder->stop();
+        const QString path = qEnvironmentVariable("LEAFTREE_RECORD_SESSION");
+        if (!sessionRecorder->session().save(path))
+            qWarning() << "Failed to write session to" << path;
+    }
+
+    // 数据源线程向更新队列投递, 必须在模型和队列销毁前停下
+    for (LiveFeedGenerator *feed : std::as_const(liveFeeds))
+        feed->stop();
+
+    // 模型还没建立就退出时不能用空状态覆盖上次保存的状态
+    if (modelsBuilt && useSavedViewState()) {
+        saveViewState(tree1);
+        saveViewState(tree2);
+    }
+
+    const QList<ModelProfiler *> profilers = findChildren<ModelProfiler *>();
+    for (const ModelProfiler *profiler : profilers)
+        qDebug() << "Model data() profile:" << profiler->summary();
+}
+
+void MainWindow::buildModels()
+{
+    // 两棵树共用一个模型, 叶节点在树之间拖放时直接 moveRows, 节点和持久索引保持不变
+    LeafTreeModel *model = setupModel();
+    setupView(tree1, model, 0, RootsPerTree);
+    setupView(tree2, model, RootsPerTree, RootsPerTree);
+
+    // LEAFTREE_LIVE_FEED=<每秒更新数> 时用本地合成数据源驱动叶节点文本和复选状态
+    if (qEnvironmentVariableIsSet("LEAFTREE_LIVE_FEED"))
+        startLiveFeed(model, qEnvironmentVariableIntValue("LEAFTREE_LIVE_FEED"));
+
+    connectSignals();
+    modelsBuilt = true;
+    StartupProfiler::mark("model build");
+
+    // 子树汇总在这里一次建好, 首次悬停提示不必等待整棵树的统计
+    SubtreeAggregates::forModel(model)->rebuild();
+    StartupProfiler::mark("subtree aggregates");
+    StartupProfiler::markFirstPaint(tree1->viewport(), "first tree paint");
+
+    // 延迟构造时外壳已经布局过, 按新内容重新计算树的高度
+    tree1->updateGeometry();
+    tree2->updateGeometry();
+
+    if (!pendingPath.isEmpty()) {
+        const QString path = pendingPath;
+        pendingPath.clear();
+        if (!goToPath(path))
+            qWarning() << "Path not found:" << path;
+    }
 }
 
 DynamicTreeView *MainWindow::createTreeView(const QString &name)
 {
     DynamicTreeView *tv = new DynamicTreeView(this);
+    tv->setObjectName(name);
     tv->setHeaderHidden(true);
     tv->setExpandsOnDoubleClick(false);
     return tv;
 }
 
-void MainWindow::setupModel(DynamicTreeView *tv)
+LeafTreeModel *MainWindow::setupModel()
 {
-    QStandardItemModel *model = new QStandardItemModel(tv);
-    model->setHorizontalHeaderLabels({"Dynamic Content"});
+    LeafTreeModel *model = new LeafTreeModel(this);
+    // 第 1 列显示子树汇总, 由 SummaryDelegate 绘制
+    model->setHeaderLabels({ "Dynamic Content", "Leaves" });
 
-    // 创建三级嵌套结构
-    for (int i = 1; i <= 3; ++i) {
-        QStandardItem *root = new QStandardItem(QString("Root %1").arg(i));
-        root->setCheckable(true);  // 启用复选框
-        root->setEditable(false);  // 禁止编辑文本
-        model->appendRow(root);
+    // 节点 ID 供实时更新、快照比对等按 ID 寻址的功能使用
+    LeafTreeModel::Snapshot snapshot;
+    quint64 nextId = 1;
+    auto addNode = [&snapshot, &nextId](quint64 parentId, const QString &text, bool checkable, double value = 0.0) {
+        LeafTreeModel::Snapshot::Node node;
+        node.id = nextId++;
+        node.parentId = parentId;
+        node.text = text;
+        node.checkable = checkable;
+        node.value = value;
+        snapshot.nodes.append(node);
+        return node.id;
+    };
 
-        for (int j = 1; j <= 2; ++j) {
-            QStandardItem *child = new QStandardItem(QString("Child %1-%2").arg(i).arg(j));
-            root->appendRow(child);
-            child->setCheckable(true);
-            child->setEditable(false);
+    // LEAFTREE_GENERATED_NODES=<节点数> 时按同样的命名生成约该数量的节点(每个根节点下更多子节点),
+    // 供回放在较大的树上重现同一段交互; 前面的行与默认的树相同
+    int childrenPerRoot = 2;
+    if (qEnvironmentVariableIsSet("LEAFTREE_GENERATED_NODES")) {
+        const int nodesPerRoot = qEnvironmentVariableIntValue("LEAFTREE_GENERATED_NODES") / (2 * RootsPerTree);
+        childrenPerRoot = qMax(childrenPerRoot, (nodesPerRoot - 1) / (1 + 4));
+    }
 
-            for (int k = 1; k <= 4; ++k) {
-                QStandardItem *leaf = new QStandardItem(QString("Leaf %1-%2-%3").arg(i).arg(j).arg(k));
-                leaf->setEditable(false);
-                child->appendRow(leaf);
-            }
+    // 创建三级嵌套结构: 根节点和子节点带复选框, 均不可编辑; 叶节点的数值计入子树汇总
+    for (int i = 1; i <= 2 * RootsPerTree; ++i) {
+        const quint64 rootId = addNode(0, QString("Root %1").arg(i), true);
+        for (int j = 1; j <= childrenPerRoot; ++j) {
+            const quint64 childId = addNode(rootId, QString("Child %1-%2").arg(i).arg(j), true);
+            for (int k = 1; k <= 4; ++k)
+                addNode(childId, QString("Leaf %1-%2-%3").arg(i).arg(j).arg(k), false, k);
         }
     }
 
-    tv->setModel(model);
-    tv->expandAll();
+    // 新数据到达时同样用 applySnapshot 增量更新, 不必重建模型
+    model->applySnapshot(snapshot);
+    return model;
+}
+
+void MainWindow::setupView(DynamicTreeView *tv, LeafTreeModel *model, int firstRoot, int rootCount)
+{
+    QAbstractItemModel *viewModel = model;
+    QVector<QAbstractProxyModel *> proxies;
+
+    // LEAFTREE_SORT_LEAFS=asc|desc[,grouped] 时按文本排序叶节点按钮, grouped 表示先按复选状态分组
+    if (qEnvironmentVariableIsSet("LEAFTREE_SORT_LEAFS")) {
+        const QStringList options = qEnvironmentVariable("LEAFTREE_SORT_LEAFS").split(',');
+        LeafSortProxyModel *sorter = new LeafSortProxyModel(tv);
+        if (options.contains("grouped"))
+            sorter->setGroupRole(Qt::CheckStateRole);
+        sorter->sort(0, options.contains("desc") ? Qt::DescendingOrder : Qt::AscendingOrder);
+        sorter->setSourceModel(viewModel);
+        viewModel = sorter;
+        proxies.append(sorter);
+    }
+
+    // LEAFTREE_PROFILE_MODEL=1 时在模型与视图之间插入 data() 调用统计代理
+    if (qEnvironmentVariableIsSet("LEAFTREE_PROFILE_MODEL")) {
+        ModelProfiler *profiler = new ModelProfiler(tv);
+        profiler->setSourceModel(viewModel);
+        profiler->attachTo(tv);
+        viewModel = profiler;
+        proxies.append(profiler);
+    }
+
+    tv->setModel(viewModel);
+    tv->setItemDelegateForColumn(1, new SummaryDelegate(tv));
+    // 汇总变化只重绘汇总列
+    connect(SubtreeAggregates::forModel(model), &SubtreeAggregates::summariesChanged, tv, [tv] {
+        const QHeaderView *header = tv->header();
+        tv->viewport()->update(QRect(header->sectionViewportPosition(1), 0,
+                                     header->sectionSize(1), tv->viewport()->height()));
+    });
+
+    // 隐藏属于另一棵树的根节点; 隐藏状态按持久索引记录, 随行移动
+    for (int row = 0; row < model->rowCount(); ++row) {
+        if (row >= firstRoot && row < firstRoot + rootCount)
+            continue;
+        QModelIndex index = model->index(row, 0);
+        for (const QAbstractProxyModel *proxy : std::as_const(proxies))
+            index = proxy->mapFromSource(index);
+        tv->setRowHidden(index.row(), index.parent(), true);
+    }
+
+    // 有上次保存的视图状态时恢复, 否则全部展开
+    if (!useSavedViewState() || !restoreViewState(tv))
+        tv->expandAll();
+}
+
+void MainWindow::saveViewState(DynamicTreeView *tv)
+{
+    QSettings settings("QT_learning", "QTreeView");
+    settings.setValue("viewState/" + tv->objectName(), TreeViewState::save(tv));
+}
+
+bool MainWindow::restoreViewState(DynamicTreeView *tv)
+{
+    QSettings settings("QT_learning", "QTreeView");
+    return TreeViewState::restore(tv, settings.value("viewState/" + tv->objectName()).toByteArray());
+}
+
+void MainWindow::startLiveFeed(LeafTreeModel *model, int updatesPerSecond)
+{
+    LiveUpdateQueue *queue = new LiveUpdateQueue(model, model);
+    LiveFeedGenerator *feed = new LiveFeedGenerator([queue](quint64 nodeId, int role, const QVariant &value) {
+        queue->post(nodeId, role, value);
+    }, queue);
+
+    QVector<quint64> labelNodes;
+    QVector<quint64> checkNodes;
+    LiveFeedGenerator::collectTargets(model, &labelNodes, &checkNodes);
+    feed->setTargets(labelNodes, checkNodes);
+    feed->start(qMax(1, updatesPerSecond));
+    liveFeeds.append(feed);
 }
 
 void MainWindow::connectSignals()
@@ -89,6 +285,7 @@ void MainWindow::connectSignals()
         tree1->updateGeometry();
         tree2->updateGeometry();
         centralWidget()->layout()->activate();
+        PERF_COUNT(Perf::LayoutActivation);
     };
 
     connect(tree1, &QTreeView::expanded, updateLayout);
@@ -97,6 +294,71 @@ void MainWindow::connectSignals()
     connect(tree2, &QTreeView::collapsed, updateLayout);
 }
 
+void MainWindow::setupGoToShortcut()
+{
+    // Ctrl+G 按路径跳转到节点
+    QShortcut *goTo = new QShortcut(QKeySequence("Ctrl+G"), this);
+    connect(goTo, &QShortcut::activated, this, [this]{
+        bool ok = false;
+        const QString path = QInputDialog::getText(this, "Go to Node", "Path (Root > Child > Leaf):",
+                                                   QLineEdit::Normal, QString(), &ok);
+        if (ok && !path.isEmpty() && !goToPath(path))
+            QMessageBox::information(this, "Go to Node", QString("'%1' was not found.").arg(path));
+    });
+}
+
+void MainWindow::setupMemoryReportShortcut()
+{
+    // Ctrl+Shift+M 输出两棵树的模型、代理缓存、持久索引和打开的对话框的内存估算
+    QShortcut *dumpMemory = new QShortcut(QKeySequence("Ctrl+Shift+M"), this);
+    connect(dumpMemory, &QShortcut::activated, this, [this]{
+        MemoryReport report;
+        report.collectFrom(this);
+        qDebug().noquote() << "Memory report:\n" + report.toText();
+    });
+}
+
+bool MainWindow::goToPath(const QString &path)
+{
+    // 模型尚未建立(延迟构造)时记下路径, 建立后再跳转
+    if (!modelsBuilt) {
+        pendingPath = path;
+        return true;
+    }
+
+    for (DynamicTreeView *tv : {tree1, tree2}) {
+        if (tv->goToPath(path)) {
+            tv->setFocus();
+            return true;
+        }
+    }
+    return false;
+}
+
+void MainWindow::setupPerfHotkeys()
+{
+    // Ctrl+Shift+P 显示/隐藏性能浮层, Ctrl+Shift+J 导出计数器 JSON
+    PerfOverlay *overlay = new PerfOverlay(centralWidget());
+    overlay->hide();
+
+    QShortcut *toggleOverlay = new QShortcut(QKeySequence("Ctrl+Shift+P"), this);
+    connect(toggleOverlay, &QShortcut::activated, overlay, [overlay]{
+        overlay->setVisible(!overlay->isVisible());
+    });
+
+    QShortcut *dumpJson = new QShortcut(QKeySequence("Ctrl+Shift+J"), this);
+    connect(dumpJson, &QShortcut::activated, this, []{
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+        const QString fileName = QString("leaftree-perf-%1.json")
+                .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+        const QString path = QDir(dir).filePath(fileName);
+        if (Perf::dumpJson(path))
+            qDebug() << "Perf counters written to" << path;
+        else
+            qWarning() << "Failed to write perf counters to" << path;
+    });
+}
+
 void MainWindow::onLeafClicked(const QModelIndex &leafIndex)
 {
     qDebug() << "Leaf clicked:" << leafIndex.data().toString();
@@ -112,18 +374,16 @@ void MainWindow::onLeafDeleted(const QModelIndex &leafIndex)
             );
 
         if (reply == QMessageBox::Yes) {
-            QStandardItemModel *model = qobject_cast<QStandardItemModel*>(
-                const_cast<QAbstractItemModel*>(leafIndex.model())
-                );
-            if (model) {
-                QModelIndex parentIndex = leafIndex.parent();
-                if (parentIndex.isValid()) {
-                    QStandardItem *parentItem = model->itemFromIndex(parentIndex);
-                    if (parentItem) {
-                        parentItem->removeRow(leafIndex.row());
-                        qDebug() << "Leaf deleted:" << leafIndex.data().toString();
-                    }
-                }
+            // 视图可能挂在代理模型上, 先映射回源模型
+            QModelIndex sourceIndex = leafIndex;
+            while (const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel*>(sourceIndex.model()))
+                sourceIndex = proxy->mapToSource(sourceIndex);
+
+            QAbstractItemModel *model = const_cast<QAbstractItemModel*>(sourceIndex.model());
+            if (model && sourceIndex.parent().isValid()) {
+                const QString leafText = sourceIndex.data().toString();
+                if (model->removeRow(sourceIndex.row(), sourceIndex.parent()))
+                    qDebug() << "Leaf deleted:" << leafText;
             }
         }
     }
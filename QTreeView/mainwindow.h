@@ -2,75 +2,15 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTreeView>
 #include <QDebug>
-#include <QStyledItemDelegate>
-#include <QApplication>
-#include <QPainter>
+#include "aligndelegate.h"
+#include "dynamictreeview.h"
 
 // 前向声明
 class LeafButtonDelegate;
-
-class AlignDelegate : public QStyledItemDelegate {
-public:
-    using QStyledItemDelegate::QStyledItemDelegate;
-
-    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
-        QStyleOptionViewItem opt = option;
-        initStyleOption(&opt, index);
-
-        // 绘制复选框
-        QRect checkboxRect = QRect(opt.rect.left() + 2, opt.rect.center().y() - 8, 16, 16);
-        bool checked = (index.data(Qt::CheckStateRole).toInt() == Qt::Checked);
-        QStyle::State state = checked ? QStyle::State_On : QStyle::State_Off;
-        QApplication::style()->drawPrimitive(QStyle::PE_IndicatorItemViewItemCheck, &opt, painter);
-
-        // 调整文本位置
-        QRect textRect = opt.rect.adjusted(24, 0, 0, 0); // 文本向右偏移24px
-        painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, index.data().toString());
-    }
-
-    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override {
-        return QSize(200, 24); // 固定项的大小
-    }
-};
-
-class DynamicTreeView : public QTreeView {
-public:
-    explicit DynamicTreeView(QWidget *parent = nullptr) : QTreeView(parent) {
-        setStyleSheet("QTreeView { border: none; padding: 0; }");
-        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-        setMouseTracking(true);  // 启用鼠标追踪
-        viewport()->setMouseTracking(true);  // 视口也需要启用鼠标追踪
-    }
-
-    QSize sizeHint() const override {
-        // 计算可见行数（包含展开的子项）
-        int visibleRows = calculateVisibleRows(rootIndex());
-        int height = visibleRows * sizeHintForRow(0);
-        height = qMin(height, 200); // 限制最大高度
-        return {width(), height};
-    }
-
-private:
-    int calculateVisibleRows(const QModelIndex &parent) const {
-        int count = 0;
-        const int rowCount = model()->rowCount(parent);
-        for (int i = 0; i < rowCount; ++i) {
-            const QModelIndex index = model()->index(i, 0, parent);
-            ++count; // 当前行
-            if (isExpanded(index)) { // 递归计算展开的子项
-                count += calculateVisibleRows(index);
-            }
-        }
-        return count;
-    }
-
-protected:
-    void updateGeometries() override {
-        QTreeView::updateGeometries();
-    }
-};
+class LeafTreeModel;
+class LiveFeedGenerator;
+class SessionRecorder;
 
 class MainWindow : public QMainWindow
 {
@@ -80,6 +20,10 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // 按 "Root > Child > Leaf" 路径依次在两棵树中查找并跳转, 找到返回 true;
+    // 延迟构造期间调用时在模型建立后再跳转
+    bool goToPath(const QString &path);
+
 private slots:
     void onLeafClicked(const QModelIndex &leafIndex);
     void onLeafDeleted(const QModelIndex &leafIndex);
@@ -88,11 +32,23 @@ private:
     DynamicTreeView *tree1;
     DynamicTreeView *tree2;
     LeafButtonDelegate *leafDelegate;
+    QList<LiveFeedGenerator *> liveFeeds;
+    SessionRecorder *sessionRecorder = nullptr;
+    bool modelsBuilt = false;
+    QString pendingPath;
 
 private:
+    void buildModels();
     DynamicTreeView* createTreeView(const QString &name);
-    void setupModel(DynamicTreeView *tv);
+    LeafTreeModel *setupModel();
+    void setupView(DynamicTreeView *tv, LeafTreeModel *model, int firstRoot, int rootCount);
+    void saveViewState(DynamicTreeView *tv);
+    bool restoreViewState(DynamicTreeView *tv);
+    void startLiveFeed(LeafTreeModel *model, int updatesPerSecond);
     void connectSignals();
+    void setupGoToShortcut();
+    void setupMemoryReportShortcut();
+    void setupPerfHotkeys();
 };
 
 #endif // MAINWINDOW_H
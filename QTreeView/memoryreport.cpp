@@ -0,0 +1,231 @@
+#include "memoryreport.h"
+#include <QDialog>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardItemModel>
+#include <QVariant>
+
+namespace {
+
+// 分配块头部与对齐的近似开销
+const quint64 ALLOCATION_OVERHEAD = 16;
+
+// QStandardItemPrivate: 模型、父项、值与子项两个容器、行列数等, 约 12 个指针宽
+const quint64 STANDARD_ITEM_PRIVATE_BYTES = 12 * sizeof(void *);
+
+// 一个 QWidget 连同 QWidgetPrivate/QWidgetData 的近似大小
+const quint64 WIDGET_BYTES = 640;
+const quint64 OBJECT_BYTES = 160;
+
+QString formatBytes(quint64 bytes)
+{
+    if (bytes >= 1024 * 1024)
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    if (bytes >= 1024)
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1 B").arg(bytes);
+}
+
+} // namespace
+
+void MemoryReport::add(const QString &subsystem, const QString &category, quint64 bytes, quint64 objects)
+{
+    for (Entry &entry : m_entries) {
+        if (entry.subsystem == subsystem && entry.category == category) {
+            entry.bytes += bytes;
+            entry.objects += objects;
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.subsystem = subsystem;
+    entry.category = category;
+    entry.bytes = bytes;
+    entry.objects = objects;
+    m_entries.append(entry);
+}
+
+void MemoryReport::collectFrom(const QObject *root)
+{
+    if (!root)
+        return;
+
+    QList<const QObject *> objects { root };
+    const QList<QObject *> children = root->findChildren<QObject *>();
+    for (const QObject *child : children)
+        objects.append(child);
+
+    for (const QObject *object : std::as_const(objects)) {
+        if (const MemoryReporter *reporter = dynamic_cast<const MemoryReporter *>(object))
+            reporter->reportMemory(*this);
+        else if (const QStandardItemModel *model = qobject_cast<const QStandardItemModel *>(object))
+            addStandardItemModel(model);
+        else if (qobject_cast<const QDialog *>(object))
+            addDialog(object);
+    }
+}
+
+const QVector<MemoryReport::Entry> &MemoryReport::entries() const
+{
+    return m_entries;
+}
+
+quint64 MemoryReport::totalBytes() const
+{
+    quint64 total = 0;
+    for (const Entry &entry : m_entries)
+        total += entry.bytes;
+    return total;
+}
+
+quint64 MemoryReport::totalObjects() const
+{
+    quint64 total = 0;
+    for (const Entry &entry : m_entries)
+        total += entry.objects;
+    return total;
+}
+
+quint64 MemoryReport::subsystemBytes(const QString &subsystem) const
+{
+    quint64 total = 0;
+    for (const Entry &entry : m_entries) {
+        if (entry.subsystem == subsystem)
+            total += entry.bytes;
+    }
+    return total;
+}
+
+QString MemoryReport::toText() const
+{
+    QString text = QString("%1 %2 %3 %4\n")
+            .arg(QString("Subsystem"), -24).arg(QString("Category"), -28)
+            .arg(QString("Objects"), 12).arg(QString("Bytes"), 12);
+    for (const Entry &entry : m_entries) {
+        text += QString("%1 %2 %3 %4\n")
+                .arg(entry.subsystem, -24).arg(entry.category, -28)
+                .arg(entry.objects, 12).arg(formatBytes(entry.bytes), 12);
+    }
+    text += QString("%1 %2 %3 %4\n")
+            .arg(QString("Total"), -24).arg(QString(), -28)
+            .arg(totalObjects(), 12).arg(formatBytes(totalBytes()), 12);
+    return text;
+}
+
+QByteArray MemoryReport::toJson() const
+{
+    QJsonArray entries;
+    for (const Entry &entry : m_entries) {
+        QJsonObject object;
+        object["subsystem"] = entry.subsystem;
+        object["category"] = entry.category;
+        object["bytes"] = double(entry.bytes);
+        object["objects"] = double(entry.objects);
+        entries.append(object);
+    }
+
+    QJsonObject root;
+    root["entries"] = entries;
+    root["totalBytes"] = double(totalBytes());
+    root["totalObjects"] = double(totalObjects());
+    return QJsonDocument(root).toJson();
+}
+
+quint64 MemoryReport::stringBytes(const QString &text)
+{
+    // 空串共享静态数据, 不占堆内存
+    if (text.isNull() || text.capacity() == 0)
+        return 0;
+    return ALLOCATION_OVERHEAD + quint64(text.capacity() + 1) * sizeof(QChar);
+}
+
+quint64 MemoryReport::hashNodeBytes(quint64 keyBytes, quint64 valueBytes)
+{
+    // 节点本身加上桶数组按 0.5 装载率分摊的指针
+    return keyBytes + valueBytes + 3 * sizeof(void *);
+}
+
+quint64 MemoryReport::mapNodeBytes(quint64 keyBytes, quint64 valueBytes)
+{
+    // 红黑树节点: 左右子节点、父节点和颜色
+    return keyBytes + valueBytes + 4 * sizeof(void *) + ALLOCATION_OVERHEAD;
+}
+
+quint64 MemoryReport::persistentIndexBytes()
+{
+    // QPersistentModelIndexData(索引加引用计数)以及模型内 索引 -> 数据 的散列表项
+    const quint64 data = sizeof(QModelIndex) + sizeof(int) + ALLOCATION_OVERHEAD;
+    return data + hashNodeBytes(sizeof(QModelIndex), sizeof(void *));
+}
+
+void MemoryReport::addStandardItemModel(const QStandardItemModel *model)
+{
+    const QString subsystem = model->objectName().isEmpty()
+            ? QString("QStandardItemModel") : QString("QStandardItemModel(%1)").arg(model->objectName());
+
+    quint64 items = 0;
+    quint64 itemBytes = 0;
+    quint64 roleValues = 0;
+    quint64 roleBytes = 0;
+    quint64 textBytes = 0;
+    quint64 childVectors = 0;
+    quint64 childVectorBytes = 0;
+
+    // 逐项遍历, 不递归, 避免深树爆栈
+    QVector<const QStandardItem *> pending { model->invisibleRootItem() };
+    while (!pending.isEmpty()) {
+        const QStandardItem *item = pending.takeLast();
+        const int rowCount = item->rowCount();
+        const int columnCount = item->columnCount();
+        if (rowCount > 0) {
+            ++childVectors;
+            childVectorBytes += ALLOCATION_OVERHEAD + quint64(rowCount) * columnCount * sizeof(void *);
+        }
+
+        for (int row = 0; row < rowCount; ++row) {
+            for (int column = 0; column < columnCount; ++column) {
+                const QStandardItem *child = item->child(row, column);
+                if (!child)
+                    continue;
+
+                ++items;
+                itemBytes += sizeof(QStandardItem) + STANDARD_ITEM_PRIVATE_BYTES + 2 * ALLOCATION_OVERHEAD;
+
+                // 每个角色存为 (角色, QVariant) 对; 字符串另有堆上的字符数据
+                const QMap<int, QVariant> values = model->itemData(child->index());
+                roleValues += values.size();
+                roleBytes += ALLOCATION_OVERHEAD + quint64(values.size()) * (sizeof(int) + sizeof(QVariant));
+                for (const QVariant &value : values) {
+                    if (value.userType() == QMetaType::QString)
+                        textBytes += stringBytes(value.toString());
+                }
+
+                if (child->hasChildren())
+                    pending.append(child);
+            }
+        }
+    }
+
+    add(subsystem, "items", itemBytes, items);
+    add(subsystem, "role values", roleBytes, roleValues);
+    add(subsystem, "text", textBytes, 0);
+    add(subsystem, "child vectors", childVectorBytes, childVectors);
+}
+
+void MemoryReport::addDialog(const QObject *dialog)
+{
+    const QList<QObject *> children = dialog->findChildren<QObject *>();
+    quint64 widgets = 1;
+    quint64 bytes = WIDGET_BYTES;
+    for (const QObject *child : children) {
+        if (child->isWidgetType()) {
+            ++widgets;
+            bytes += WIDGET_BYTES;
+        } else {
+            bytes += OBJECT_BYTES;
+        }
+    }
+    add("Dialogs", dialog->metaObject()->className(), bytes, widgets);
+}
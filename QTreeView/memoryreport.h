@@ -0,0 +1,61 @@
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QObject;
+class QStandardItemModel;
+
+// 内存统计报告: 各子系统按 (子系统, 类别) 报告字节数和对象数
+// 数值为估算: 按容器节点与 Qt 私有数据的已知布局近似, 不含分配器自身的开销
+class MemoryReport
+{
+public:
+    struct Entry {
+        QString subsystem;
+        QString category;
+        quint64 bytes = 0;
+        quint64 objects = 0;
+    };
+
+    void add(const QString &subsystem, const QString &category, quint64 bytes, quint64 objects);
+
+    // 遍历 root 及其全部子对象: 实现了 MemoryReporter 的对象自行报告,
+    // QStandardItemModel 统计条目存储, QDialog 统计其控件树
+    void collectFrom(const QObject *root);
+
+    const QVector<Entry> &entries() const;
+    quint64 totalBytes() const;
+    quint64 totalObjects() const;
+    // 同一子系统所有类别的字节数之和
+    quint64 subsystemBytes(const QString &subsystem) const;
+
+    QString toText() const;
+    QByteArray toJson() const;
+
+    // 常用类型的估算
+    static quint64 stringBytes(const QString &text);
+    static quint64 hashNodeBytes(quint64 keyBytes, quint64 valueBytes);
+    static quint64 mapNodeBytes(quint64 keyBytes, quint64 valueBytes);
+    // QPersistentModelIndex 的共享数据及其在模型中的登记项; 同一索引的多个副本只算一次
+    static quint64 persistentIndexBytes();
+
+private:
+    void addStandardItemModel(const QStandardItemModel *model);
+    void addDialog(const QObject *dialog);
+
+    QVector<Entry> m_entries;
+};
+
+// 支持内存统计的子系统实现该接口
+class MemoryReporter
+{
+public:
+    virtual ~MemoryReporter() = default;
+    virtual void reportMemory(MemoryReport &report) const = 0;
+};
+
+#endif // MEMORYREPORT_H
@@ -0,0 +1,104 @@
+#include "modelprofiler.h"
+#include "treeroles.h"
+#include <QAbstractItemView>
+#include <QEvent>
+#include <QStringList>
+
+ModelProfiler::ModelProfiler(QObject *parent)
+    : QIdentityProxyModel(parent)
+{
+}
+
+ModelProfiler::~ModelProfiler()
+{
+}
+
+void ModelProfiler::attachTo(QAbstractItemView *view)
+{
+    view->viewport()->installEventFilter(this);
+}
+
+QVariant ModelProfiler::data(const QModelIndex &index, int role) const
+{
+    countRole(role);
+    return QIdentityProxyModel::data(index, role);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+void ModelProfiler::multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const
+{
+    for (const QModelRoleData &roleData : roleDataSpan)
+        countRole(roleData.role());
+
+    // 直接转发给源模型, 避免基类实现逐个角色回调 data() 造成重复计数
+    if (sourceModel())
+        sourceModel()->multiData(mapToSource(index), roleDataSpan);
+}
+#endif
+
+bool ModelProfiler::hasChildren(const QModelIndex &parent) const
+{
+    countRole(HasChildrenPseudoRole);
+    return QIdentityProxyModel::hasChildren(parent);
+}
+
+void ModelProfiler::endFrame()
+{
+    quint64 frameCalls = 0;
+    for (auto it = m_currentFrame.constBegin(); it != m_currentFrame.constEnd(); ++it)
+        frameCalls += it.value();
+
+    m_peakFrameCalls = qMax(m_peakFrameCalls, frameCalls);
+    m_lastFrame = m_currentFrame;
+    m_currentFrame.clear();
+    ++m_frameCount;
+}
+
+QString ModelProfiler::summary() const
+{
+    QStringList parts;
+    for (auto it = m_totals.constBegin(); it != m_totals.constEnd(); ++it) {
+        const double perFrame = m_frameCount ? double(it.value()) / m_frameCount : 0.0;
+        parts << QString("%1=%2 (%3/frame)").arg(roleName(it.key())).arg(it.value()).arg(perFrame, 0, 'f', 1);
+    }
+    return QString("frames=%1 peak=%2 %3").arg(m_frameCount).arg(m_peakFrameCalls).arg(parts.join(' '));
+}
+
+QString ModelProfiler::roleName(int role)
+{
+    switch (role) {
+    case HasChildrenPseudoRole: return "hasChildren";
+    case Qt::DisplayRole: return "DisplayRole";
+    case Qt::DecorationRole: return "DecorationRole";
+    case Qt::EditRole: return "EditRole";
+    case Qt::ToolTipRole: return "ToolTipRole";
+    case Qt::StatusTipRole: return "StatusTipRole";
+    case Qt::WhatsThisRole: return "WhatsThisRole";
+    case Qt::SizeHintRole: return "SizeHintRole";
+    case Qt::FontRole: return "FontRole";
+    case Qt::TextAlignmentRole: return "TextAlignmentRole";
+    case Qt::BackgroundRole: return "BackgroundRole";
+    case Qt::ForegroundRole: return "ForegroundRole";
+    case Qt::CheckStateRole: return "CheckStateRole";
+    case Qt::AccessibleTextRole: return "AccessibleTextRole";
+    case NodeIdRole: return "NodeIdRole";
+    case NodeValueRole: return "NodeValueRole";
+    case HasChildrenRole: return "HasChildrenRole";
+    default: break;
+    }
+    return QString("Role%1").arg(role);
+}
+
+bool ModelProfiler::eventFilter(QObject *obj, QEvent *event)
+{
+    // 新的一次绘制开始, 结算上一帧
+    if (event->type() == QEvent::Paint)
+        endFrame();
+    return QIdentityProxyModel::eventFilter(obj, event);
+}
+
+void ModelProfiler::countRole(int role) const
+{
+    ++m_currentFrame[role];
+    ++m_totals[role];
+}
@@ -0,0 +1,55 @@
+#ifndef MODELPROFILER_H
+#define MODELPROFILER_H
+
+#include <QIdentityProxyModel>
+#include <QMap>
+
+class QAbstractItemView;
+
+// 透明代理: 统计视图/代理对源模型的 data() 调用次数(按角色), 以及 hasChildren 调用
+// 以视口的两次 Paint 之间为一帧
+class ModelProfiler : public QIdentityProxyModel
+{
+    Q_OBJECT
+
+public:
+    typedef QMap<int, quint64> RoleCounts;
+
+    // hasChildren 不是角色, 记在这个伪角色下
+    static const int HasChildrenPseudoRole = -1;
+
+    explicit ModelProfiler(QObject *parent = nullptr);
+    ~ModelProfiler() override;
+
+    void attachTo(QAbstractItemView *view);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    void multiData(const QModelIndex &index, QModelRoleDataSpan roleDataSpan) const override;
+#endif
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+
+    RoleCounts lastFrame() const { return m_lastFrame; }
+    RoleCounts totals() const { return m_totals; }
+    quint64 frameCount() const { return m_frameCount; }
+    quint64 peakFrameCalls() const { return m_peakFrameCalls; }
+
+    void endFrame();
+    QString summary() const;
+
+    static QString roleName(int role);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    mutable RoleCounts m_currentFrame;
+    mutable RoleCounts m_totals;
+    RoleCounts m_lastFrame;
+    quint64 m_frameCount = 0;
+    quint64 m_peakFrameCalls = 0;
+
+    void countRole(int role) const;
+};
+
+#endif // MODELPROFILER_H
@@ -0,0 +1,61 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 无锁多生产者单消费者队列(Vyukov 链表队列)
+// push 可以在任意线程调用; pop 只能由一个消费者线程调用
+// 生产者刚交换完头指针、尚未链接时 pop 可能暂时返回 false, 该元素会在下一次 pop 中取到
+template <typename T>
+class MpscQueue
+{
+public:
+    MpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+    ~MpscQueue()
+    {
+        T value;
+        while (pop(value)) {}
+        if (m_tail != &m_stub)
+            delete m_tail;
+    }
+
+    void push(T value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    bool pop(T &value)
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        // next 成为新的哨兵节点, 其值已被取走
+        value = std::move(next->value);
+        m_tail = next;
+        if (tail != &m_stub)
+            delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next { nullptr };
+        T value;
+    };
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    Node m_stub;
+    std::atomic<Node *> m_head;
+    Node *m_tail;
+};
+
+#endif // MPSCQUEUE_H
@@ -0,0 +1,284 @@
+#include "pathindex.h"
+#include "treeroles.h"
+#include <QAbstractItemModel>
+
+namespace {
+
+// 顶层节点的父节点键
+const quint64 ROOT_KEY = 0;
+
+// 把 labels 中 oldRow 这一行的散列表项改为 newRow
+void moveRow(QMultiHash<QString, int> &rows, const QString &label, int oldRow, int newRow)
+{
+    auto it = rows.find(label, oldRow);
+    if (it != rows.end())
+        it.value() = newRow;
+}
+
+} // namespace
+
+PathIndex::PathIndex(QAbstractItemModel *model, QObject *parent)
+    : QObject(parent), m_model(model)
+{
+    if (!model)
+        return;
+
+    connect(model, &QAbstractItemModel::rowsInserted, this, &PathIndex::onRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &PathIndex::onRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::rowsMoved, this, &PathIndex::onRowsMoved);
+    connect(model, &QAbstractItemModel::dataChanged, this, &PathIndex::onDataChanged);
+    connect(model, &QAbstractItemModel::layoutChanged, this, &PathIndex::invalidate);
+    connect(model, &QAbstractItemModel::modelReset, this, &PathIndex::invalidate);
+}
+
+QAbstractItemModel *PathIndex::model() const
+{
+    return m_model;
+}
+
+QString PathIndex::separator()
+{
+    return QStringLiteral(" > ");
+}
+
+QStringList PathIndex::splitPath(const QString &path)
+{
+    QStringList labels = path.split(separator());
+    for (QString &label : labels)
+        label = label.trimmed();
+    return labels;
+}
+
+QString PathIndex::pathFor(const QModelIndex &index)
+{
+    QStringList labels;
+    for (QModelIndex node = index; node.isValid(); node = node.parent())
+        labels.prepend(node.sibling(node.row(), 0).data().toString());
+    return labels.join(separator());
+}
+
+QModelIndex PathIndex::find(const QString &path) const
+{
+    return find(splitPath(path));
+}
+
+QModelIndex PathIndex::find(const QStringList &labels) const
+{
+    if (!m_model || labels.isEmpty())
+        return QModelIndex();
+    if (m_dirty)
+        rebuild();
+
+    QModelIndex node;
+    for (const QString &label : labels) {
+        int row = -1;
+        if (const Level *level = levelFor(node)) {
+            for (auto it = level->rows.constFind(label); it != level->rows.constEnd() && it.key() == label; ++it)
+                row = row < 0 ? it.value() : qMin(row, it.value());
+        } else if (node.isValid() && nodeId(node) == 0) {
+            // 没有 ID 的父节点: 线性扫描
+            const int rowCount = m_model->rowCount(node);
+            for (int r = 0; r < rowCount && row < 0; ++r) {
+                if (m_model->index(r, 0, node).data().toString() == label)
+                    row = r;
+            }
+        }
+
+        if (row < 0)
+            return QModelIndex();
+        node = m_model->index(row, 0, node);
+    }
+    return node;
+}
+
+void PathIndex::rebuild() const
+{
+    m_levels.clear();
+    m_dirty = false;
+    if (m_model)
+        indexChildren(QModelIndex());
+}
+
+int PathIndex::indexedParents() const
+{
+    return m_levels.size();
+}
+
+void PathIndex::reportMemory(MemoryReport &report) const
+{
+    // 文本与模型隐式共享, 这里只计表结构本身
+    quint64 entries = 0;
+    quint64 bytes = 0;
+    for (const Level &level : std::as_const(m_levels)) {
+        entries += level.labels.size();
+        bytes += MemoryReport::hashNodeBytes(sizeof(quint64), sizeof(Level))
+                + quint64(level.labels.capacity()) * sizeof(QString)
+                + quint64(level.rows.size()) * MemoryReport::hashNodeBytes(sizeof(QString), sizeof(int));
+    }
+    report.add("PathIndex", "label tables", bytes, entries);
+}
+
+quint64 PathIndex::nodeId(const QModelIndex &index) const
+{
+    return index.isValid() ? index.sibling(index.row(), 0).data(NodeIdRole).toULongLong() : ROOT_KEY;
+}
+
+PathIndex::Level *PathIndex::levelFor(const QModelIndex &parent) const
+{
+    const quint64 key = nodeId(parent);
+    if (parent.isValid() && key == ROOT_KEY)
+        return nullptr;
+    auto it = m_levels.find(key);
+    return it != m_levels.end() ? &it.value() : nullptr;
+}
+
+void PathIndex::indexChildren(const QModelIndex &parent) const
+{
+    indexLevel(parent);
+
+    const int rowCount = m_model->rowCount(parent);
+    for (int row = 0; row < rowCount; ++row) {
+        const QModelIndex child = m_model->index(row, 0, parent);
+        if (m_model->hasChildren(child))
+            indexChildren(child);
+    }
+}
+
+void PathIndex::indexLevel(const QModelIndex &parent) const
+{
+    const quint64 key = nodeId(parent);
+    if (parent.isValid() && key == ROOT_KEY)
+        return;
+
+    const int rowCount = m_model->rowCount(parent);
+    if (rowCount == 0) {
+        m_levels.remove(key);
+        return;
+    }
+
+    Level &level = m_levels[key];
+    level.labels.resize(rowCount);
+    level.rows.clear();
+    level.rows.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        const QString label = m_model->index(row, 0, parent).data().toString();
+        level.labels[row] = label;
+        level.rows.insert(label, row);
+    }
+}
+
+void PathIndex::dropChildren(const QModelIndex &parent)
+{
+    const int rowCount = m_model->rowCount(parent);
+    for (int row = 0; row < rowCount; ++row) {
+        const QModelIndex child = m_model->index(row, 0, parent);
+        if (m_model->hasChildren(child))
+            dropChildren(child);
+    }
+
+    const quint64 key = nodeId(parent);
+    if (key != ROOT_KEY)
+        m_levels.remove(key);
+}
+
+void PathIndex::invalidate()
+{
+    m_levels.clear();
+    m_dirty = true;
+}
+
+void PathIndex::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (m_dirty)
+        return;
+
+    const int count = last - first + 1;
+    const quint64 key = nodeId(parent);
+    if (!parent.isValid() || key != ROOT_KEY) {
+        Level &level = m_levels[key];
+
+        // 从后往前后移插入点之后的行号, 同名兄弟节点不会相互覆盖
+        for (int row = level.labels.size() - 1; row >= first; --row)
+            moveRow(level.rows, level.labels.at(row), row, row + count);
+        level.labels.insert(first, count, QString());
+
+        for (int row = first; row <= last; ++row) {
+            const QString label = m_model->index(row, 0, parent).data().toString();
+            level.labels[row] = label;
+            level.rows.insert(label, row);
+        }
+    }
+
+    for (int row = first; row <= last; ++row) {
+        const QModelIndex child = m_model->index(row, 0, parent);
+        if (m_model->hasChildren(child))
+            indexChildren(child);
+    }
+}
+
+void PathIndex::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (m_dirty)
+        return;
+
+    for (int row = first; row <= last; ++row) {
+        const QModelIndex child = m_model->index(row, 0, parent);
+        if (m_model->hasChildren(child))
+            dropChildren(child);
+    }
+
+    Level *level = levelFor(parent);
+    if (!level || last >= level->labels.size())
+        return;
+
+    const int count = last - first + 1;
+    for (int row = first; row <= last; ++row)
+        level->rows.remove(level->labels.at(row), row);
+    for (int row = last + 1; row < level->labels.size(); ++row)
+        moveRow(level->rows, level->labels.at(row), row, row - count);
+    level->labels.remove(first, count);
+
+    if (level->labels.isEmpty())
+        m_levels.remove(nodeId(parent));
+}
+
+void PathIndex::onRowsMoved(const QModelIndex &sourceParent, int start, int end,
+                            const QModelIndex &destinationParent, int row)
+{
+    Q_UNUSED(start);
+    Q_UNUSED(end);
+    Q_UNUSED(row);
+    if (m_dirty)
+        return;
+
+    // 被移动的子树按 ID 寻址, 其下各级不受影响; 只需重建两端父节点这一级
+    indexLevel(sourceParent);
+    if (destinationParent != sourceParent)
+        indexLevel(destinationParent);
+}
+
+void PathIndex::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (m_dirty || topLeft.column() > 0)
+        return;
+    if (roles.contains(NodeIdRole)) {
+        invalidate();
+        return;
+    }
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole))
+        return;
+
+    Level *level = levelFor(topLeft.parent());
+    if (!level)
+        return;
+
+    for (int row = topLeft.row(); row <= bottomRight.row() && row < level->labels.size(); ++row) {
+        const QString label = topLeft.sibling(row, 0).data().toString();
+        const QString &oldLabel = level->labels.at(row);
+        if (label == oldLabel)
+            continue;
+        level->rows.remove(oldLabel, row);
+        level->rows.insert(label, row);
+        level->labels[row] = label;
+    }
+}
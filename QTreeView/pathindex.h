@@ -0,0 +1,68 @@
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QMultiHash>
+#include <QPointer>
+#include <QStringList>
+#include <QVector>
+#include "memoryreport.h"
+
+class QAbstractItemModel;
+class QModelIndex;
+
+// 按 "Root > Child > Leaf" 路径查找节点的索引
+// 每个有子节点的父节点保存 子节点文本 -> 行号 的散列表, 父节点按稳定 ID(NodeIdRole)寻址, 顶层为 0;
+// 查找时逐级各做一次散列查找, 与树的规模无关.
+// 插入、删除、改名和移动只更新受影响的父节点, 布局变化和重置后在下次查找时整体重建.
+// 没有 NodeIdRole 的父节点不建表, 查找到这一级时退化为线性扫描
+class PathIndex : public QObject, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    explicit PathIndex(QAbstractItemModel *model, QObject *parent = nullptr);
+
+    QAbstractItemModel *model() const;
+
+    // 路径各级之间的分隔符, 与详情对话框显示的格式一致
+    static QString separator();
+    static QStringList splitPath(const QString &path);
+    static QString pathFor(const QModelIndex &index);
+
+    // 找不到时返回无效索引; 同名兄弟节点取行号最小的一个
+    QModelIndex find(const QString &path) const;
+    QModelIndex find(const QStringList &labels) const;
+
+    // 立即建立索引(默认在首次查找时建立)
+    void rebuild() const;
+    int indexedParents() const;
+
+    void reportMemory(MemoryReport &report) const override;
+
+private:
+    struct Level {
+        QVector<QString> labels;       // 按行号, 与模型中的字符串隐式共享
+        QMultiHash<QString, int> rows;
+    };
+
+    quint64 nodeId(const QModelIndex &index) const;
+    Level *levelFor(const QModelIndex &parent) const;
+    void indexChildren(const QModelIndex &parent) const;
+    void indexLevel(const QModelIndex &parent) const;
+    void dropChildren(const QModelIndex &parent);
+    void invalidate();
+
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsMoved(const QModelIndex &sourceParent, int start, int end,
+                     const QModelIndex &destinationParent, int row);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+    QPointer<QAbstractItemModel> m_model;
+    mutable QHash<quint64, Level> m_levels;
+    mutable bool m_dirty = true;
+};
+
+#endif // PATHINDEX_H
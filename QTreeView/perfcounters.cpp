@@ -0,0 +1,195 @@
+#include "perfcounters.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <atomic>
+#include <vector>
+
+namespace Perf {
+
+namespace {
+
+// 单个线程的计数块: 只有所属线程写入, 因此 load+store 即可, 不需要原子读改写
+struct ThreadBlock {
+    std::atomic<quint64> calls[CounterCount];
+    std::atomic<quint64> totalNs[CounterCount];
+    std::atomic<quint64> histogram[CounterCount][HistogramBuckets];
+
+    ThreadBlock()
+    {
+        for (int c = 0; c < CounterCount; ++c) {
+            calls[c].store(0, std::memory_order_relaxed);
+            totalNs[c].store(0, std::memory_order_relaxed);
+            for (int b = 0; b < HistogramBuckets; ++b)
+                histogram[c][b].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// 线程退出后计数块仍保留在注册表中, 保证累计值不丢失
+QMutex g_registryMutex;
+std::vector<ThreadBlock *> g_blocks;
+
+ThreadBlock *registerBlock()
+{
+    ThreadBlock *block = new ThreadBlock;
+    QMutexLocker locker(&g_registryMutex);
+    g_blocks.push_back(block);
+    return block;
+}
+
+ThreadBlock &localBlock()
+{
+    thread_local ThreadBlock *block = registerBlock();
+    return *block;
+}
+
+inline void bump(std::atomic<quint64> &value, quint64 delta)
+{
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+int bucketFor(quint64 ns)
+{
+    if (ns == 0)
+        return 0;
+    return qMin(HistogramBuckets - 1, 64 - int(qCountLeadingZeroBits(ns)));
+}
+
+// 由直方图估算分位数, 取所在桶的上界
+quint64 percentileNs(const CounterSnapshot &counter, double percentile)
+{
+    if (counter.calls == 0)
+        return 0;
+    const quint64 target = quint64(counter.calls * percentile);
+    quint64 seen = 0;
+    for (int b = 0; b < HistogramBuckets; ++b) {
+        seen += counter.histogram[b];
+        if (seen > target)
+            return quint64(1) << b;
+    }
+    return quint64(1) << (HistogramBuckets - 1);
+}
+
+Snapshot g_frameBaseline;
+FrameStats g_lastFrame;
+
+} // namespace
+
+const char *counterName(Counter counter)
+{
+    switch (counter) {
+    case DelegatePaint: return "delegatePaint";
+    case LeafLayout: return "leafLayout";
+    case DelegateSizeHint: return "delegateSizeHint";
+    case TreeSizeHint: return "treeSizeHint";
+    case ModelData: return "modelData";
+    case ViewPaint: return "viewPaint";
+    case LayoutActivation: return "layoutActivation";
+    case MouseMoveReceived: return "mouseMoveReceived";
+    case MouseMoveDispatched: return "mouseMoveDispatched";
+    case IdlePrefetch: return "idlePrefetch";
+    case CounterCount: break;
+    }
+    return "unknown";
+}
+
+void record(Counter counter, quint64 ns)
+{
+    ThreadBlock &block = localBlock();
+    bump(block.calls[counter], 1);
+    bump(block.totalNs[counter], ns);
+    bump(block.histogram[counter][bucketFor(ns)], 1);
+}
+
+void count(Counter counter)
+{
+    bump(localBlock().calls[counter], 1);
+}
+
+Snapshot snapshot()
+{
+    Snapshot result;
+    QMutexLocker locker(&g_registryMutex);
+    for (const ThreadBlock *block : g_blocks) {
+        for (int c = 0; c < CounterCount; ++c) {
+            CounterSnapshot &counter = result.counters[c];
+            counter.calls += block->calls[c].load(std::memory_order_relaxed);
+            counter.totalNs += block->totalNs[c].load(std::memory_order_relaxed);
+            for (int b = 0; b < HistogramBuckets; ++b)
+                counter.histogram[b] += block->histogram[c][b].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void endFrame(quint64 paintNs)
+{
+    const Snapshot current = snapshot();
+
+    FrameStats frame;
+    frame.frameNumber = g_lastFrame.frameNumber + 1;
+    frame.paintMs = paintNs / 1e6;
+    frame.rowsPainted = current.counters[DelegatePaint].calls - g_frameBaseline.counters[DelegatePaint].calls;
+    frame.sizeHintCalls = current.counters[DelegateSizeHint].calls - g_frameBaseline.counters[DelegateSizeHint].calls
+            + current.counters[TreeSizeHint].calls - g_frameBaseline.counters[TreeSizeHint].calls;
+    frame.layoutActivations = current.counters[LayoutActivation].calls
+            - g_frameBaseline.counters[LayoutActivation].calls;
+
+    g_lastFrame = frame;
+    g_frameBaseline = current;
+}
+
+FrameStats lastFrame()
+{
+    return g_lastFrame;
+}
+
+QByteArray toJson()
+{
+    const Snapshot current = snapshot();
+
+    QJsonObject counters;
+    for (int c = 0; c < CounterCount; ++c) {
+        const CounterSnapshot &counter = current.counters[c];
+
+        QJsonArray histogram;
+        for (int b = 0; b < HistogramBuckets; ++b)
+            histogram.append(double(counter.histogram[b]));
+
+        QJsonObject object;
+        object["calls"] = double(counter.calls);
+        object["totalNs"] = double(counter.totalNs);
+        object["p50Ns"] = double(percentileNs(counter, 0.50));
+        object["p95Ns"] = double(percentileNs(counter, 0.95));
+        object["p99Ns"] = double(percentileNs(counter, 0.99));
+        object["histogramLog2Ns"] = histogram;
+        counters[counterName(Counter(c))] = object;
+    }
+
+    QJsonObject frame;
+    frame["frameNumber"] = double(g_lastFrame.frameNumber);
+    frame["paintMs"] = g_lastFrame.paintMs;
+    frame["rowsPainted"] = double(g_lastFrame.rowsPainted);
+    frame["sizeHintCalls"] = double(g_lastFrame.sizeHintCalls);
+    frame["layoutActivations"] = double(g_lastFrame.layoutActivations);
+
+    QJsonObject root;
+    root["counters"] = counters;
+    root["lastFrame"] = frame;
+    return QJsonDocument(root).toJson();
+}
+
+bool dumpJson(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(toJson()) >= 0;
+}
+
+} // namespace Perf
@@ -0,0 +1,111 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QtGlobal>
+#include <QString>
+#include <chrono>
+
+// 轻量级性能计数器
+// 通过 qmake CONFIG+=perf_counters (定义 LEAFTREE_PERF_COUNTERS) 打开;
+// 关闭时 PERF_* 宏展开为空, 热路径上没有任何额外开销
+namespace Perf {
+
+enum Counter {
+    DelegatePaint,       // LeafButtonDelegate::paint
+    LeafLayout,          // LeafButtonDelegate::updateLeafLayouts
+    DelegateSizeHint,    // LeafButtonDelegate::sizeHint
+    TreeSizeHint,        // DynamicTreeView::sizeHint
+    ModelData,           // 代理中的 model data() 调用
+    ViewPaint,           // DynamicTreeView::paintEvent (一帧)
+    LayoutActivation,    // MainWindow 中的布局激活
+    MouseMoveReceived,   // DynamicTreeView 收到的鼠标移动
+    MouseMoveDispatched, // 合并后派发给 QTreeView 与代理的鼠标移动
+    IdlePrefetch,        // DynamicTreeView 空闲预取的一个时间片
+    CounterCount
+};
+
+// 直方图按耗时的 2 的幂分桶: 第 b 个桶覆盖 [2^(b-1), 2^b) 纳秒
+const int HistogramBuckets = 32;
+
+struct CounterSnapshot {
+    quint64 calls = 0;
+    quint64 totalNs = 0;
+    quint64 histogram[HistogramBuckets] = {};
+};
+
+struct Snapshot {
+    CounterSnapshot counters[CounterCount];
+};
+
+// 最近一帧的统计, 只在 GUI 线程上更新
+struct FrameStats {
+    quint64 frameNumber = 0;
+    double paintMs = 0.0;
+    quint64 rowsPainted = 0;
+    quint64 sizeHintCalls = 0;
+    quint64 layoutActivations = 0;
+};
+
+const char *counterName(Counter counter);
+
+// 每个线程写自己的计数块(单写者, 无锁), 读取时汇总所有线程
+void record(Counter counter, quint64 ns);
+void count(Counter counter);
+Snapshot snapshot();
+
+void endFrame(quint64 paintNs);
+FrameStats lastFrame();
+
+QByteArray toJson();
+bool dumpJson(const QString &filePath);
+
+inline quint64 nowNs()
+{
+    return quint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Counter counter) : m_counter(counter), m_start(nowNs()) {}
+    ~ScopedTimer() { record(m_counter, nowNs() - m_start); }
+
+private:
+    Q_DISABLE_COPY(ScopedTimer)
+    Counter m_counter;
+    quint64 m_start;
+};
+
+class FrameScope
+{
+public:
+    FrameScope() : m_start(nowNs()) {}
+    ~FrameScope()
+    {
+        const quint64 elapsed = nowNs() - m_start;
+        record(ViewPaint, elapsed);
+        endFrame(elapsed);
+    }
+
+private:
+    Q_DISABLE_COPY(FrameScope)
+    quint64 m_start;
+};
+
+} // namespace Perf
+
+#ifdef LEAFTREE_PERF_COUNTERS
+// 变量名带上行号, 同一作用域内可以有多个 PERF_SCOPE
+#define PERF_CONCAT_IMPL(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_IMPL(a, b)
+#define PERF_SCOPE(counter) Perf::ScopedTimer PERF_CONCAT(perfScopedTimer_, __LINE__)(counter)
+#define PERF_COUNT(counter) Perf::count(counter)
+#define PERF_FRAME() Perf::FrameScope perfFrameScope_
+#else
+#define PERF_SCOPE(counter) do {} while (0)
+#define PERF_COUNT(counter) do {} while (0)
+#define PERF_FRAME() do {} while (0)
+#endif
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,81 @@
+#include "perfoverlay.h"
+#include "perfcounters.h"
+#include <QEvent>
+#include <QPainter>
+#include <QTimer>
+
+PerfOverlay::PerfOverlay(QWidget *parent)
+    : QWidget(parent)
+    , m_refreshTimer(new QTimer(this))
+{
+    // 浮层完全不透明: 刷新时不会连带重绘下面的树视图, 避免污染统计
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFixedSize(210, 100);
+
+    parent->installEventFilter(this);
+    reposition();
+
+    m_refreshTimer->setInterval(250);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]{
+        sampleMouseMoveRates();
+        update();
+    });
+    m_refreshTimer->start();
+    m_sampleClock.start();
+}
+
+PerfOverlay::~PerfOverlay()
+{
+}
+
+void PerfOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    const Perf::FrameStats frame = Perf::lastFrame();
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+    painter.setPen(QColor(120, 255, 120));
+
+    const QStringList lines = {
+        QString("frame #%1").arg(frame.frameNumber),
+        QString("paint: %1 ms").arg(frame.paintMs, 0, 'f', 2),
+        QString("rows painted: %1").arg(frame.rowsPainted),
+        QString("sizeHint calls: %1").arg(frame.sizeHintCalls),
+        QString("layout activations: %1").arg(frame.layoutActivations),
+        QString("mouse moves/s: %1 -> %2").arg(qRound(m_movesReceivedPerSecond))
+                                          .arg(qRound(m_movesDispatchedPerSecond))
+    };
+    painter.drawText(rect().adjusted(6, 4, -6, -4), Qt::AlignLeft | Qt::AlignTop, lines.join('\n'));
+}
+
+bool PerfOverlay::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == parentWidget() && event->type() == QEvent::Resize)
+        reposition();
+    return QWidget::eventFilter(obj, event);
+}
+
+void PerfOverlay::sampleMouseMoveRates()
+{
+    const Perf::Snapshot current = Perf::snapshot();
+    const quint64 received = current.counters[Perf::MouseMoveReceived].calls;
+    const quint64 dispatched = current.counters[Perf::MouseMoveDispatched].calls;
+
+    const double seconds = m_sampleClock.restart() / 1000.0;
+    if (seconds > 0) {
+        m_movesReceivedPerSecond = (received - m_lastMovesReceived) / seconds;
+        m_movesDispatchedPerSecond = (dispatched - m_lastMovesDispatched) / seconds;
+    }
+    m_lastMovesReceived = received;
+    m_lastMovesDispatched = dispatched;
+}
+
+void PerfOverlay::reposition()
+{
+    // 固定在父窗口右上角
+    move(parentWidget()->width() - width() - 8, 8);
+    raise();
+}
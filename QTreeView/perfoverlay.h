@@ -0,0 +1,36 @@
+#ifndef PERFOVERLAY_H
+#define PERFOVERLAY_H
+
+#include <QElapsedTimer>
+#include <QWidget>
+
+class QTimer;
+
+// 屏幕角落的性能浮层: 显示最近一帧的绘制耗时、绘制行数、sizeHint 调用次数和布局激活次数,
+// 以及每秒收到的鼠标移动数与合并后派发给代理的次数
+class PerfOverlay : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerfOverlay(QWidget *parent);
+    ~PerfOverlay() override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    QTimer *m_refreshTimer;
+
+    QElapsedTimer m_sampleClock;
+    quint64 m_lastMovesReceived = 0;
+    quint64 m_lastMovesDispatched = 0;
+    double m_movesReceivedPerSecond = 0.0;
+    double m_movesDispatchedPerSecond = 0.0;
+
+    void sampleMouseMoveRates();
+    void reposition();
+};
+
+#endif // PERFOVERLAY_H
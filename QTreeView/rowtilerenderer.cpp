@@ -0,0 +1,200 @@
+#include "rowtilerenderer.h"
+#include "leafstrip.h"
+#include <QCoreApplication>
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QThread>
+
+namespace {
+
+const qint64 DEFAULT_CACHE_BYTES = 64 * 1024 * 1024;
+const int CHECK_BOX_SIZE = 13;
+const int CHECK_BOX_MARGIN = 4;
+
+} // namespace
+
+RowTileRenderer::RowTileRenderer(QObject *parent)
+    : QObject(parent)
+{
+    // 留一个核心给 GUI 线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    setMaxCacheBytes(DEFAULT_CACHE_BYTES);
+}
+
+RowTileRenderer::~RowTileRenderer()
+{
+    // 工作线程持有 this 指针投递结果, 必须在成员析构前全部结束
+    m_pool.waitForDone();
+}
+
+void RowTileRenderer::setMaxCacheBytes(qint64 bytes)
+{
+    m_cache.setMaxCost(int(qMax<qint64>(1, bytes / 1024)));
+}
+
+qint64 RowTileRenderer::maxCacheBytes() const
+{
+    return qint64(m_cache.maxCost()) * 1024;
+}
+
+QImage RowTileRenderer::tile(const TileKey &key) const
+{
+    if (const QImage *image = m_cache.object(key)) {
+        ++m_hits;
+        return *image;
+    }
+    ++m_misses;
+    return QImage();
+}
+
+void RowTileRenderer::insertTile(const TileKey &key, const QImage &image)
+{
+    const int cost = int(qMax<qint64>(1, image.sizeInBytes() / 1024));
+    m_cache.insert(key, new QImage(image), cost);
+}
+
+bool RowTileRenderer::requestTile(const TileKey &key, const RowSnapshot &snapshot)
+{
+    if (!canRenderAsync() || m_cache.contains(key) || m_pending.contains(key))
+        return false;
+
+    m_pending.insert(key);
+    const quint64 generation = m_generation;
+    m_pool.start([this, key, snapshot, generation] {
+        const QImage image = renderTile(snapshot);
+        QMetaObject::invokeMethod(this, [this, key, image, generation] {
+            finishTile(key, image, generation);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+void RowTileRenderer::finishTile(const TileKey &key, const QImage &image, quint64 generation)
+{
+    // 渲染期间发生过 invalidate, 快照已过期
+    if (generation != m_generation)
+        return;
+    // 渲染期间该行的数据变了
+    auto stale = m_stale.find(key);
+    if (stale != m_stale.end()) {
+        if (--stale.value() == 0)
+            m_stale.erase(stale);
+        return;
+    }
+
+    m_pending.remove(key);
+    insertTile(key, image);
+    ++m_asyncRendered;
+}
+
+void RowTileRenderer::invalidate()
+{
+    m_cache.clear();
+    m_pending.clear();
+    m_stale.clear();
+    ++m_generation;
+}
+
+void RowTileRenderer::invalidateRows(const void *model, const QSet<QPair<quintptr, int>> &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    auto matches = [model, &rows](const TileKey &key) {
+        return key.model == model && rows.contains(qMakePair(key.internalId, key.row));
+    };
+    const QList<TileKey> cached = m_cache.keys();
+    for (const TileKey &key : cached) {
+        if (matches(key))
+            m_cache.remove(key);
+    }
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (matches(*it)) {
+            ++m_stale[*it];
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RowTileRenderer::waitForIdle()
+{
+    m_pool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+void RowTileRenderer::reportMemory(MemoryReport &report) const
+{
+    // 缓存代价即图块像素字节数(以 KB 计)
+    const quint64 entryBytes = MemoryReport::hashNodeBytes(sizeof(TileKey), sizeof(QImage) + 4 * sizeof(void *));
+    report.add("RowTileRenderer", "tile cache", quint64(m_cache.totalCost()) * 1024 + m_cache.size() * entryBytes,
+               m_cache.size());
+    report.add("RowTileRenderer", "pending tiles",
+               m_pending.size() * MemoryReport::hashNodeBytes(sizeof(TileKey), 0), m_pending.size());
+}
+
+bool RowTileRenderer::canRenderAsync()
+{
+    // 部分平台的字体引擎只能在 GUI 线程使用, 此时只做同步渲染
+    return QFontDatabase::supportsThreadedFontRendering();
+}
+
+QImage RowTileRenderer::renderTile(const RowSnapshot &snapshot)
+{
+    const QSize pixelSize = snapshot.size * snapshot.devicePixelRatio;
+    QImage image(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(snapshot.devicePixelRatio);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(snapshot.font);
+    paintSnapshot(&painter, snapshot);
+    return image;
+}
+
+void RowTileRenderer::paintSnapshot(QPainter *painter, const RowSnapshot &snapshot)
+{
+    // QStyle 和 QPixmapCache 只能在 GUI 线程使用, 这里用不依赖样式的方式绘制行内容
+    const QRect rowRect(QPoint(0, 0), snapshot.size);
+    painter->fillRect(rowRect, snapshot.palette.brush(snapshot.selected ? QPalette::Highlight : QPalette::Base));
+
+    int textLeft = CHECK_BOX_MARGIN;
+    if (snapshot.checkable) {
+        const QRect box(CHECK_BOX_MARGIN, rowRect.center().y() - CHECK_BOX_SIZE / 2, CHECK_BOX_SIZE, CHECK_BOX_SIZE);
+        painter->setPen(snapshot.palette.color(QPalette::Mid));
+        painter->setBrush(snapshot.palette.brush(QPalette::Base));
+        painter->drawRect(box);
+
+        painter->setPen(QPen(snapshot.palette.color(QPalette::Text), 2));
+        if (snapshot.checkState == Qt::Checked) {
+            const QRect inner = box.adjusted(3, 3, -3, -3);
+            painter->drawLine(inner.left(), inner.center().y(), inner.center().x(), inner.bottom());
+            painter->drawLine(inner.center().x(), inner.bottom(), inner.right(), inner.top());
+        } else if (snapshot.checkState == Qt::PartiallyChecked) {
+            painter->fillRect(box.adjusted(3, 3, -2, -2), snapshot.palette.brush(QPalette::Text));
+        }
+        textLeft = box.right() + CHECK_BOX_MARGIN + 1;
+    }
+
+    painter->setPen(snapshot.palette.color(snapshot.selected ? QPalette::HighlightedText : QPalette::Text));
+    painter->drawText(rowRect.adjusted(textLeft, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, snapshot.text);
+
+    if (!snapshot.childRow)
+        return;
+
+    // 与 LeafButtonDelegate::updateLeafLayouts 使用相同的几何, 只画快照中可见的那一段
+    const LeafStrip::StripLayout strip = LeafStrip::layoutStrip(
+                rowRect, QFontMetrics(snapshot.font).horizontalAdvance(snapshot.text),
+                snapshot.leafCount, snapshot.hasMore, snapshot.hasCollapse, snapshot.stripOffset);
+    painter->save();
+    painter->setClipRect(strip.clip);
+    for (int i = 0; i < snapshot.leafLabels.size(); ++i)
+        LeafStrip::paintLeafButton(painter, strip.slotRect(snapshot.leafSlots.at(i)), snapshot.leafLabels.at(i), false);
+    if (snapshot.hasMore)
+        LeafStrip::paintMoreButton(painter, strip.slotRect(strip.leafCount));
+    if (snapshot.hasCollapse)
+        LeafStrip::paintCollapseButton(painter, strip.slotRect(strip.slotCount() - 1));
+    painter->restore();
+}
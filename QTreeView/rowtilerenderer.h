@@ -0,0 +1,131 @@
+#ifndef ROWTILERENDERER_H
+#define ROWTILERENDERER_H
+
+#include <QObject>
+#include <QCache>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QPalette>
+#include <QSet>
+#include <QSize>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include "memoryreport.h"
+
+// 一行绘制所需的全部数据, 在 GUI 线程上从模型和代理状态复制出来;
+// 工作线程只读快照, 从不访问活动模型
+struct RowSnapshot {
+    QSize size;
+    qreal devicePixelRatio = 1.0;
+    QFont font;
+    QPalette palette;
+    bool selected = false;
+
+    QString text;
+    bool checkable = false;
+    Qt::CheckState checkState = Qt::Unchecked;
+
+    // 子节点行: 按钮条的滚动量, 可见部分的叶节点按钮文本及其槽位, 以及"..."/收起按钮
+    bool childRow = false;
+    int stripOffset = 0;
+    int leafCount = 0;
+    QStringList leafLabels;
+    QVector<int> leafSlots;
+    bool hasMore = false;
+    bool hasCollapse = false;
+};
+
+// 行图块渲染器: 工作线程把视口附近的行预先绘制到 QImage, GUI 线程只需贴图
+// 图块只包含静态内容, 悬停与键盘焦点由代理在贴图之后叠加绘制
+class RowTileRenderer : public QObject, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    struct TileKey {
+        const void *model = nullptr;
+        quintptr internalId = 0;
+        int row = -1;
+        int column = -1;
+        QSize size;
+        bool selected = false;
+        qreal devicePixelRatio = 1.0;
+        int stripOffset = 0;
+
+        bool operator==(const TileKey &other) const
+        {
+            return model == other.model && internalId == other.internalId
+                    && row == other.row && column == other.column
+                    && size == other.size && selected == other.selected
+                    && devicePixelRatio == other.devicePixelRatio
+                    && stripOffset == other.stripOffset;
+        }
+    };
+
+    explicit RowTileRenderer(QObject *parent = nullptr);
+    ~RowTileRenderer() override;
+
+    // 缓存上限按图块像素字节计
+    void setMaxCacheBytes(qint64 bytes);
+    qint64 maxCacheBytes() const;
+
+    // 命中时返回图块, 未命中返回空图
+    QImage tile(const TileKey &key) const;
+    bool hasTile(const TileKey &key) const { return m_cache.contains(key); }
+    void insertTile(const TileKey &key, const QImage &image);
+
+    // 在工作线程中渲染图块, 已缓存、已在排队或平台不支持线程内字体绘制时返回 false
+    bool requestTile(const TileKey &key, const RowSnapshot &snapshot);
+
+    // 模型或代理状态变化后丢弃所有图块, 正在渲染的旧结果到达后也会被丢弃
+    void invalidate();
+    // 只丢弃给定行(internalId, 行号)的图块, 用于数据变化; 这些行正在渲染的结果到达后同样被丢弃
+    void invalidateRows(const void *model, const QSet<QPair<quintptr, int>> &rows);
+
+    // 等待所有工作线程完成并把结果放入缓存(基准测试用)
+    void waitForIdle();
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+    quint64 asyncRendered() const { return m_asyncRendered; }
+
+    void reportMemory(MemoryReport &report) const override;
+
+    static bool canRenderAsync();
+    static QImage renderTile(const RowSnapshot &snapshot);
+
+private:
+    static void paintSnapshot(QPainter *painter, const RowSnapshot &snapshot);
+    void finishTile(const TileKey &key, const QImage &image, quint64 generation);
+
+    QThreadPool m_pool;
+    mutable QCache<TileKey, QImage> m_cache;   // 代价以 KB 计
+    QSet<TileKey> m_pending;
+    QHash<TileKey, int> m_stale;   // 已失效但仍在渲染的图块 -> 待丢弃的结果数
+    quint64 m_generation = 0;
+    mutable quint64 m_hits = 0;
+    mutable quint64 m_misses = 0;
+    quint64 m_asyncRendered = 0;
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+inline size_t qHash(const RowTileRenderer::TileKey &key, size_t seed = 0)
+#else
+inline uint qHash(const RowTileRenderer::TileKey &key, uint seed = 0)
+#endif
+{
+    auto h = qHash(quintptr(key.model), seed);
+    h = h * 31 + qHash(key.internalId, seed);
+    h = h * 31 + qHash(key.row, seed);
+    h = h * 31 + qHash(key.column, seed);
+    h = h * 31 + qHash(key.size.width(), seed);
+    h = h * 31 + qHash(key.size.height(), seed);
+    h = h * 31 + qHash(key.devicePixelRatio, seed);
+    h = h * 31 + qHash(key.stripOffset, seed);
+    return h * 2 + (key.selected ? 1 : 0);
+}
+
+#endif // ROWTILERENDERER_H
@@ -0,0 +1,408 @@
+#include "sessionrecorder.h"
+#include <QChildEvent>
+#include <QDataStream>
+#include <QFile>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QRegularExpression>
+#include <QWheelEvent>
+#include <QWidget>
+
+namespace {
+
+const quint32 SessionMagic = 0x4C545352; // "LTSR"
+const quint16 SessionVersion = 2;
+
+// 修饰键都在高位, 右移后一个字节即可容纳
+quint8 packModifiers(Qt::KeyboardModifiers modifiers)
+{
+    return quint8(quint32(modifiers) >> 25);
+}
+
+Qt::KeyboardModifiers unpackModifiers(quint8 packed)
+{
+    return Qt::KeyboardModifiers(int(quint32(packed) << 25));
+}
+
+qint16 clampCoordinate(int value)
+{
+    return qint16(qBound(-32768, value, 32767));
+}
+
+// QMouseEvent::pos() 与 QWheelEvent::pos() 在 Qt 6 中已弃用
+QPoint eventPos(const QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+QPoint eventPos(const QWheelEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+} // namespace
+
+bool InteractionSession::write(QIODevice *device) const
+{
+    QDataStream out(device);
+    out.setVersion(QDataStream::Qt_5_12);
+
+    out << SessionMagic << SessionVersion << qint32(rootSize.width()) << qint32(rootSize.height());
+    out << quint32(widgets.size());
+    for (const QString &widget : widgets)
+        out << widget;
+
+    out << quint32(events.size());
+    for (const Event &event : events) {
+        out << event.timeMs << event.widget << quint8(event.kind);
+        if (event.isMouse() || event.kind == Event::Wheel) {
+            out << clampCoordinate(event.pos.x()) << clampCoordinate(event.pos.y())
+                << quint32(event.buttons) << packModifiers(event.modifiers);
+        }
+        if (event.isMouse())
+            out << quint32(event.button);
+        if (event.kind == Event::Wheel)
+            out << clampCoordinate(event.angleDelta.x()) << clampCoordinate(event.angleDelta.y());
+        if (event.isKey())
+            out << qint32(event.key) << packModifiers(event.modifiers) << event.text << quint8(event.autoRepeat);
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+bool InteractionSession::read(QIODevice *device)
+{
+    QDataStream in(device);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    in >> magic >> version >> width >> height;
+    if (magic != SessionMagic || version != SessionVersion)
+        return false;
+
+    InteractionSession session;
+    session.rootSize = QSize(width, height);
+
+    quint32 widgetCount = 0;
+    in >> widgetCount;
+    for (quint32 i = 0; i < widgetCount && in.status() == QDataStream::Ok; ++i) {
+        QString widget;
+        in >> widget;
+        session.widgets.append(widget);
+    }
+
+    quint32 eventCount = 0;
+    in >> eventCount;
+    for (quint32 i = 0; i < eventCount && in.status() == QDataStream::Ok; ++i) {
+        Event event;
+        quint8 kind = 0;
+        in >> event.timeMs >> event.widget >> kind;
+        if (kind > Event::KeyRelease || event.widget >= session.widgets.size())
+            return false;
+        event.kind = Event::Kind(kind);
+
+        if (event.isMouse() || event.kind == Event::Wheel) {
+            qint16 x = 0;
+            qint16 y = 0;
+            quint32 buttons = 0;
+            quint8 modifiers = 0;
+            in >> x >> y >> buttons >> modifiers;
+            event.pos = QPoint(x, y);
+            event.buttons = Qt::MouseButtons(int(buttons));
+            event.modifiers = unpackModifiers(modifiers);
+        }
+        if (event.isMouse()) {
+            quint32 button = 0;
+            in >> button;
+            event.button = Qt::MouseButton(button);
+        }
+        if (event.kind == Event::Wheel) {
+            qint16 dx = 0;
+            qint16 dy = 0;
+            in >> dx >> dy;
+            event.angleDelta = QPoint(dx, dy);
+        }
+        if (event.isKey()) {
+            qint32 key = 0;
+            quint8 modifiers = 0;
+            quint8 autoRepeat = 0;
+            in >> key >> modifiers >> event.text >> autoRepeat;
+            event.key = key;
+            event.modifiers = unpackModifiers(modifiers);
+            event.autoRepeat = autoRepeat != 0;
+        }
+        session.events.append(event);
+    }
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+    *this = session;
+    return true;
+}
+
+bool InteractionSession::save(const QString &filePath) const
+{
+    QFile file(filePath);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && write(&file);
+}
+
+bool InteractionSession::load(const QString &filePath)
+{
+    QFile file(filePath);
+    return file.open(QIODevice::ReadOnly) && read(&file);
+}
+
+QString InteractionSession::kindName(Event::Kind kind)
+{
+    switch (kind) {
+    case Event::MousePress: return "mousePress";
+    case Event::MouseRelease: return "mouseRelease";
+    case Event::MouseDoubleClick: return "mouseDoubleClick";
+    case Event::MouseMove: return "mouseMove";
+    case Event::Wheel: return "wheel";
+    case Event::KeyPress: return "keyPress";
+    case Event::KeyRelease: return "keyRelease";
+    }
+    return "unknown";
+}
+
+SessionRecorder::SessionRecorder(QWidget *root, QObject *parent)
+    : QObject(parent), m_root(root)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+QWidget *SessionRecorder::root() const
+{
+    return m_root;
+}
+
+void SessionRecorder::start()
+{
+    stop();
+    if (!m_root)
+        return;
+
+    m_session = InteractionSession();
+    m_session.rootSize = m_root->size();
+    m_widgetIds.clear();
+    m_lastEvent = nullptr;
+    m_lastWidget = nullptr;
+
+    watch(m_root);
+    const QList<QWidget *> children = m_root->findChildren<QWidget *>();
+    for (QWidget *child : children)
+        watch(child);
+
+    m_clock.start();
+    m_recording = true;
+}
+
+void SessionRecorder::stop()
+{
+    m_recording = false;
+    for (const QPointer<QWidget> &widget : std::as_const(m_watched)) {
+        if (widget)
+            widget->removeEventFilter(this);
+    }
+    m_watched.clear();
+}
+
+bool SessionRecorder::isRecording() const
+{
+    return m_recording;
+}
+
+InteractionSession SessionRecorder::session() const
+{
+    return m_session;
+}
+
+QString SessionRecorder::widgetPath(const QWidget *root, const QWidget *widget)
+{
+    if (!root || !widget)
+        return QString();
+    if (widget == root)
+        return QString(".");
+
+    QStringList segments;
+    for (const QWidget *current = widget; current != root; current = current->parentWidget()) {
+        // 对话框等独立窗口也沿 parentWidget() 上溯; 到顶仍未遇到根控件则不在这棵控件树中
+        const QWidget *parent = current->parentWidget();
+        if (!parent)
+            return QString();
+        if (!current->objectName().isEmpty()) {
+            segments.prepend(current->objectName());
+            continue;
+        }
+
+        int ordinal = 0;
+        for (const QObject *sibling : parent->children()) {
+            if (sibling == current)
+                break;
+            if (sibling->isWidgetType() && sibling->objectName().isEmpty()
+                    && sibling->metaObject() == current->metaObject())
+                ++ordinal;
+        }
+        segments.prepend(QString("%1[%2]").arg(current->metaObject()->className()).arg(ordinal));
+    }
+    return segments.join('/');
+}
+
+QWidget *SessionRecorder::findWidget(QWidget *root, const QString &path)
+{
+    if (!root || path.isEmpty())
+        return nullptr;
+    if (path == ".")
+        return root;
+
+    static const QRegularExpression ordinalPattern("^(.+)\\[(\\d+)\\]$");
+    QWidget *current = root;
+    for (const QString &segment : path.split('/')) {
+        QWidget *next = nullptr;
+        const QObjectList children = current->children();
+        for (QObject *child : children) {
+            if (child->isWidgetType() && child->objectName() == segment) {
+                next = static_cast<QWidget *>(child);
+                break;
+            }
+        }
+
+        const QRegularExpressionMatch match = ordinalPattern.match(segment);
+        if (!next && match.hasMatch()) {
+            const QString className = match.captured(1);
+            int ordinal = match.captured(2).toInt();
+            for (QObject *child : children) {
+                if (!child->isWidgetType() || !child->objectName().isEmpty()
+                        || className != QLatin1String(child->metaObject()->className()))
+                    continue;
+                if (ordinal-- == 0) {
+                    next = static_cast<QWidget *>(child);
+                    break;
+                }
+            }
+        }
+
+        if (!next)
+            return nullptr;
+        current = next;
+    }
+    return current;
+}
+
+bool SessionRecorder::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::ChildAdded: {
+        // 之后创建的子控件(包括以根控件内的控件为父窗口的对话框)也要录制
+        QObject *child = static_cast<QChildEvent *>(event)->child();
+        if (m_recording && child->isWidgetType())
+            watch(static_cast<QWidget *>(child));
+        break;
+    }
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+        if (m_recording && event->spontaneous() && watched->isWidgetType())
+            record(static_cast<QWidget *>(watched), event);
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void SessionRecorder::watch(QWidget *widget)
+{
+    for (const QPointer<QWidget> &watched : std::as_const(m_watched)) {
+        if (watched == widget)
+            return;
+    }
+    widget->installEventFilter(this);
+    m_watched.append(widget);
+}
+
+void SessionRecorder::record(QWidget *widget, QEvent *event)
+{
+    // 未被接受的输入沿父控件传播: 按键事件是同一个对象, 鼠标事件每级重新构造但时间戳相同
+    const quint64 timestamp = static_cast<const QInputEvent *>(event)->timestamp();
+    if (event->type() == m_lastType && m_lastWidget && widget != m_lastWidget && widget->isAncestorOf(m_lastWidget)
+            && (event == m_lastEvent || (timestamp != 0 && timestamp == m_lastTimestamp)))
+        return;
+
+    const QString path = widgetPath(m_root, widget);
+    if (path.isEmpty())
+        return;
+    auto idIt = m_widgetIds.constFind(path);
+    if (idIt == m_widgetIds.constEnd()) {
+        if (m_session.widgets.size() > 0xffff)
+            return;
+        idIt = m_widgetIds.insert(path, quint16(m_session.widgets.size()));
+        m_session.widgets.append(path);
+    }
+
+    InteractionSession::Event recorded;
+    recorded.timeMs = quint32(m_clock.elapsed());
+    recorded.widget = idIt.value();
+
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove: {
+        const QMouseEvent *mouseEvent = static_cast<const QMouseEvent *>(event);
+        recorded.kind = event->type() == QEvent::MouseButtonPress ? InteractionSession::Event::MousePress
+                : event->type() == QEvent::MouseButtonRelease ? InteractionSession::Event::MouseRelease
+                : event->type() == QEvent::MouseButtonDblClick ? InteractionSession::Event::MouseDoubleClick
+                : InteractionSession::Event::MouseMove;
+        recorded.pos = eventPos(mouseEvent);
+        recorded.button = mouseEvent->button();
+        recorded.buttons = mouseEvent->buttons();
+        recorded.modifiers = mouseEvent->modifiers();
+        break;
+    }
+    case QEvent::Wheel: {
+        const QWheelEvent *wheelEvent = static_cast<const QWheelEvent *>(event);
+        recorded.kind = InteractionSession::Event::Wheel;
+        recorded.pos = eventPos(wheelEvent);
+        recorded.buttons = wheelEvent->buttons();
+        recorded.modifiers = wheelEvent->modifiers();
+        recorded.angleDelta = wheelEvent->angleDelta();
+        break;
+    }
+    default: {
+        const QKeyEvent *keyEvent = static_cast<const QKeyEvent *>(event);
+        recorded.kind = event->type() == QEvent::KeyPress ? InteractionSession::Event::KeyPress
+                                                          : InteractionSession::Event::KeyRelease;
+        recorded.key = keyEvent->key();
+        recorded.modifiers = keyEvent->modifiers();
+        recorded.text = keyEvent->text();
+        recorded.autoRepeat = keyEvent->isAutoRepeat();
+        break;
+    }
+    }
+    m_session.events.append(recorded);
+
+    m_lastEvent = event;
+    m_lastTimestamp = timestamp;
+    m_lastType = event->type();
+    m_lastWidget = widget;
+}
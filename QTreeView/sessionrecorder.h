@@ -0,0 +1,106 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPoint>
+#include <QPointer>
+#include <QSize>
+#include <QStringList>
+#include <QVector>
+
+class QIODevice;
+class QWidget;
+
+// 一段录制的交互: 输入事件按时间顺序排列, 目标控件以相对根控件的路径表示, 回放时按路径重新查找.
+// 二进制格式(QDataStream): 头部(魔数、版本、根控件尺寸)、控件路径表、事件表; 每个事件只写出其类型用到的字段;
+// 鼠标按键按 32 位写出, 以保留 ExtraButton3 及以上的按键(版本 2)
+struct InteractionSession
+{
+    struct Event {
+        enum Kind : quint8 {
+            MousePress,
+            MouseRelease,
+            MouseDoubleClick,
+            MouseMove,
+            Wheel,
+            KeyPress,
+            KeyRelease
+        };
+
+        quint32 timeMs = 0;           // 相对录制开始
+        quint16 widget = 0;           // widgets 中的下标
+        Kind kind = MouseMove;
+        QPoint pos;                   // 目标控件坐标
+        Qt::MouseButton button = Qt::NoButton;
+        Qt::MouseButtons buttons;
+        Qt::KeyboardModifiers modifiers;
+        QPoint angleDelta;            // 滚轮
+        int key = 0;                  // 按键
+        QString text;
+        bool autoRepeat = false;
+
+        bool isMouse() const { return kind <= MouseMove; }
+        bool isKey() const { return kind == KeyPress || kind == KeyRelease; }
+    };
+
+    QSize rootSize;
+    QStringList widgets;
+    QVector<Event> events;
+
+    bool write(QIODevice *device) const;
+    bool read(QIODevice *device);
+    bool save(const QString &filePath) const;
+    bool load(const QString &filePath);
+
+    quint32 durationMs() const { return events.isEmpty() ? 0 : events.last().timeMs; }
+    static QString kindName(Event::Kind kind);
+};
+
+// 交互录制: 只在给定根控件及其子控件(包括之后创建的子控件和以它为父窗口的对话框)上安装事件过滤器,
+// 不像应用级过滤器那样看到程序中的所有事件. 只记录来自窗口系统的鼠标、滚轮和按键事件,
+// 事件沿父控件传播时只记第一个接收者; 回放时发出的事件不是自发的, 不会被再次录入
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SessionRecorder(QWidget *root, QObject *parent = nullptr);
+    ~SessionRecorder() override;
+
+    QWidget *root() const;
+
+    // start() 清空已录制的内容并以根控件当前尺寸开始计时
+    void start();
+    void stop();
+    bool isRecording() const;
+
+    InteractionSession session() const;
+
+    // 控件路径: 自根控件向下每级为 objectName, 没有名字时为 "类名[同类兄弟中的序号]", 以 "/" 分隔; 根控件为 "."
+    static QString widgetPath(const QWidget *root, const QWidget *widget);
+    static QWidget *findWidget(QWidget *root, const QString &path);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void watch(QWidget *widget);
+    void record(QWidget *widget, QEvent *event);
+
+    QPointer<QWidget> m_root;
+    QVector<QPointer<QWidget>> m_watched;
+    QElapsedTimer m_clock;
+    bool m_recording = false;
+    InteractionSession m_session;
+    QHash<QString, quint16> m_widgetIds;
+
+    // 传播去重: 最近记录的事件与其接收者
+    const QEvent *m_lastEvent = nullptr;
+    quint64 m_lastTimestamp = 0;
+    int m_lastType = 0;
+    QPointer<QWidget> m_lastWidget;
+};
+
+#endif // SESSIONRECORDER_H
@@ -0,0 +1,206 @@
+#include "sessionreplayer.h"
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QKeySequence>
+#include <QMouseEvent>
+#include <QStringList>
+#include <QTimer>
+#include <QWheelEvent>
+#include <QWidget>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 已排序样本的分位数(最近秩)
+double percentileMs(const QVector<qint64> &sorted, double percentile)
+{
+    if (sorted.isEmpty())
+        return 0.0;
+    // 最近秩法: 第 ceil(n * p) 个样本
+    const int rank = qBound(0, int(std::ceil(sorted.size() * percentile)) - 1, int(sorted.size()) - 1);
+    return sorted.at(rank) / 1e6;
+}
+
+SessionReplayer::ActionStats statsFor(const QString &action, QVector<qint64> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    SessionReplayer::ActionStats stats;
+    stats.action = action;
+    stats.count = samples.size();
+    stats.p50Ms = percentileMs(samples, 0.50);
+    stats.p95Ms = percentileMs(samples, 0.95);
+    stats.p99Ms = percentileMs(samples, 0.99);
+    stats.maxMs = samples.isEmpty() ? 0.0 : samples.last() / 1e6;
+    for (qint64 ns : std::as_const(samples))
+        stats.totalMs += ns / 1e6;
+    return stats;
+}
+
+} // namespace
+
+SessionReplayer::SessionReplayer(QWidget *root, const InteractionSession &session, QObject *parent)
+    : QObject(parent), m_root(root), m_session(session)
+{
+}
+
+void SessionReplayer::setRecordedTiming(bool enabled)
+{
+    m_recordedTiming = enabled;
+}
+
+bool SessionReplayer::recordedTiming() const
+{
+    return m_recordedTiming;
+}
+
+void SessionReplayer::start()
+{
+    m_finished = false;
+    m_next = 0;
+    m_replayed = 0;
+    m_skipped = 0;
+    m_latencies.clear();
+
+    // 路径中的坐标依赖布局, 先恢复录制时的窗口尺寸
+    if (m_root && m_session.rootSize.isValid())
+        m_root->resize(m_session.rootSize);
+    QCoreApplication::sendPostedEvents();
+
+    m_clock.start();
+    scheduleNext();
+}
+
+bool SessionReplayer::isFinished() const
+{
+    return m_finished;
+}
+
+int SessionReplayer::replayedEvents() const
+{
+    return m_replayed;
+}
+
+int SessionReplayer::skippedEvents() const
+{
+    return m_skipped;
+}
+
+qint64 SessionReplayer::elapsedMs() const
+{
+    return m_finished ? m_durationMs : (m_clock.isValid() ? m_clock.elapsed() : 0);
+}
+
+QVector<SessionReplayer::ActionStats> SessionReplayer::stats() const
+{
+    QVector<ActionStats> result;
+    QVector<qint64> all;
+    for (auto it = m_latencies.constBegin(); it != m_latencies.constEnd(); ++it) {
+        result.append(statsFor(it.key(), it.value()));
+        all += it.value();
+    }
+    result.append(statsFor("all", all));
+    return result;
+}
+
+QString SessionReplayer::summary() const
+{
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6")
+             .arg("action", -28).arg("count", 7).arg("p50 ms", 9).arg("p95 ms", 9).arg("p99 ms", 9).arg("max ms", 9);
+    for (const ActionStats &stats : this->stats()) {
+        lines << QString("%1 %2 %3 %4 %5 %6")
+                 .arg(stats.action, -28).arg(stats.count, 7)
+                 .arg(stats.p50Ms, 9, 'f', 3).arg(stats.p95Ms, 9, 'f', 3)
+                 .arg(stats.p99Ms, 9, 'f', 3).arg(stats.maxMs, 9, 'f', 3);
+    }
+    lines << QString("replayed %1 events, skipped %2, %3 ms").arg(m_replayed).arg(m_skipped).arg(elapsedMs());
+    return lines.join('\n');
+}
+
+QString SessionReplayer::actionName(const InteractionSession::Event &event)
+{
+    const QString kind = InteractionSession::kindName(event.kind);
+    if (event.isKey())
+        return QString("%1 %2").arg(kind, QKeySequence(event.key).toString());
+    return kind;
+}
+
+void SessionReplayer::scheduleNext()
+{
+    if (m_next >= m_session.events.size()) {
+        if (!m_finished) {
+            m_finished = true;
+            m_durationMs = m_clock.elapsed();
+            emit finished();
+        }
+        return;
+    }
+
+    qint64 delay = 0;
+    if (m_recordedTiming)
+        delay = qMax<qint64>(0, qint64(m_session.events.at(m_next).timeMs) - m_clock.elapsed());
+    QTimer::singleShot(int(delay), Qt::PreciseTimer, this, &SessionReplayer::replayNext);
+}
+
+void SessionReplayer::replayNext()
+{
+    const InteractionSession::Event event = m_session.events.at(m_next++);
+    QWidget *target = SessionRecorder::findWidget(m_root, m_session.widgets.at(event.widget));
+    if (!target || !target->isVisible()) {
+        ++m_skipped;
+        scheduleNext();
+        return;
+    }
+
+    // 0ms 定时器在事件循环回到空闲时触发; 事件打开模态对话框时在对话框的事件循环中触发,
+    // 因此这里先排队再发出事件
+    m_pendingAction = actionName(event);
+    m_actionTimer.start();
+    QTimer::singleShot(0, this, &SessionReplayer::finishAction);
+    deliver(target, event);
+}
+
+void SessionReplayer::finishAction()
+{
+    // 把本事件引起的布局、重绘等投递事件处理完再计时
+    QCoreApplication::sendPostedEvents();
+    m_latencies[m_pendingAction].append(m_actionTimer.nsecsElapsed());
+    ++m_replayed;
+    scheduleNext();
+}
+
+void SessionReplayer::deliver(QWidget *target, const InteractionSession::Event &event)
+{
+    const QPointF localPos(event.pos);
+    const QPointF globalPos(target->mapToGlobal(event.pos));
+
+    switch (event.kind) {
+    case InteractionSession::Event::MousePress:
+    case InteractionSession::Event::MouseRelease:
+    case InteractionSession::Event::MouseDoubleClick:
+    case InteractionSession::Event::MouseMove: {
+        const QEvent::Type type = event.kind == InteractionSession::Event::MousePress ? QEvent::MouseButtonPress
+                : event.kind == InteractionSession::Event::MouseRelease ? QEvent::MouseButtonRelease
+                : event.kind == InteractionSession::Event::MouseDoubleClick ? QEvent::MouseButtonDblClick
+                : QEvent::MouseMove;
+        QMouseEvent mouseEvent(type, localPos, globalPos, event.button, event.buttons, event.modifiers);
+        QCoreApplication::sendEvent(target, &mouseEvent);
+        break;
+    }
+    case InteractionSession::Event::Wheel: {
+        QWheelEvent wheelEvent(localPos, globalPos, QPoint(), event.angleDelta, event.buttons, event.modifiers,
+                               Qt::NoScrollPhase, false);
+        QCoreApplication::sendEvent(target, &wheelEvent);
+        break;
+    }
+    case InteractionSession::Event::KeyPress:
+    case InteractionSession::Event::KeyRelease: {
+        QKeyEvent keyEvent(event.kind == InteractionSession::Event::KeyPress ? QEvent::KeyPress : QEvent::KeyRelease,
+                           event.key, event.modifiers, event.text, event.autoRepeat);
+        QCoreApplication::sendEvent(target, &keyEvent);
+        break;
+    }
+    }
+}
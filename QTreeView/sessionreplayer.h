@@ -0,0 +1,76 @@
+#ifndef SESSIONREPLAYER_H
+#define SESSIONREPLAYER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QPointer>
+#include <QVector>
+#include "sessionrecorder.h"
+
+class QWidget;
+
+// 交互回放: 把录制的事件按路径发给根控件下的同一控件, 并测量每个事件的延迟 ——
+// 从发出事件到事件循环处理完由它引起的已投递事件(包括重绘)为止.
+// 打开模态对话框的事件在对话框的事件循环中完成测量, 之后的事件照常在其中回放
+class SessionReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 一类动作的延迟分布, 动作按事件类型区分, 按键再按键名细分
+    struct ActionStats {
+        QString action;
+        int count = 0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        double totalMs = 0.0;
+    };
+
+    SessionReplayer(QWidget *root, const InteractionSession &session, QObject *parent = nullptr);
+
+    // true(默认)时按录制的时间间隔发出事件, 依赖定时器的行为(例如鼠标移动合并)与录制时一致;
+    // false 时每个事件处理完立即发出下一个
+    void setRecordedTiming(bool enabled);
+    bool recordedTiming() const;
+
+    // 把根控件调整为录制时的尺寸后开始回放, 结束时发出 finished()
+    void start();
+    bool isFinished() const;
+
+    int replayedEvents() const;
+    // 找不到目标控件而跳过的事件
+    int skippedEvents() const;
+    qint64 elapsedMs() const;
+
+    QVector<ActionStats> stats() const;
+    QString summary() const;
+
+    static QString actionName(const InteractionSession::Event &event);
+
+signals:
+    void finished();
+
+private:
+    void scheduleNext();
+    void replayNext();
+    void finishAction();
+    void deliver(QWidget *target, const InteractionSession::Event &event);
+
+    QPointer<QWidget> m_root;
+    InteractionSession m_session;
+    bool m_recordedTiming = true;
+    bool m_finished = false;
+    int m_next = 0;
+    int m_replayed = 0;
+    int m_skipped = 0;
+    qint64 m_durationMs = 0;
+    QElapsedTimer m_clock;
+    QElapsedTimer m_actionTimer;
+    QString m_pendingAction;
+    QMap<QString, QVector<qint64>> m_latencies;
+};
+
+#endif // SESSIONREPLAYER_H
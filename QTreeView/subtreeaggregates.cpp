@@ -0,0 +1,420 @@
+#include "subtreeaggregates.h"
+#include "treeroles.h"
+#include <QAbstractItemModel>
+#include <QAbstractProxyModel>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+
+namespace {
+
+// 顶层(整个模型)的键
+const quint64 ROOT_KEY = 0;
+
+// 一层节点数少于该值时串行求和, 不值得分发到线程池
+const int MIN_PARALLEL_LEVEL = 4096;
+
+// 把 [begin, end) 分成若干块, 返回每块的 [begin, end)
+QVector<QPair<int, int>> splitRanges(int begin, int end)
+{
+    const int size = end - begin;
+    const int chunks = qMax(1, qMin(QThread::idealThreadCount(), size / (MIN_PARALLEL_LEVEL / 4)));
+    QVector<QPair<int, int>> ranges;
+    for (int i = 0; i < chunks; ++i)
+        ranges.append(qMakePair(begin + int(qint64(size) * i / chunks), begin + int(qint64(size) * (i + 1) / chunks)));
+    return ranges;
+}
+
+} // namespace
+
+SubtreeAggregates::Summary &SubtreeAggregates::Summary::operator+=(const Summary &other)
+{
+    leafs += other.leafs;
+    checked += other.checked;
+    sum += other.sum;
+    return *this;
+}
+
+SubtreeAggregates::Summary &SubtreeAggregates::Summary::operator-=(const Summary &other)
+{
+    leafs -= other.leafs;
+    checked -= other.checked;
+    sum -= other.sum;
+    return *this;
+}
+
+bool SubtreeAggregates::Summary::operator==(const Summary &other) const
+{
+    return leafs == other.leafs && checked == other.checked && sum == other.sum;
+}
+
+SubtreeAggregates::SubtreeAggregates(QAbstractItemModel *model, QObject *parent)
+    : QObject(parent), m_model(model), m_valueRole(NodeValueRole)
+{
+    if (!model)
+        return;
+
+    connect(model, &QAbstractItemModel::rowsInserted, this, &SubtreeAggregates::onRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SubtreeAggregates::onRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &SubtreeAggregates::onRowsRemoved);
+    connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, &SubtreeAggregates::onRowsAboutToBeMoved);
+    connect(model, &QAbstractItemModel::rowsMoved, this, &SubtreeAggregates::onRowsMoved);
+    connect(model, &QAbstractItemModel::dataChanged, this, &SubtreeAggregates::onDataChanged);
+    connect(model, &QAbstractItemModel::layoutChanged, this, &SubtreeAggregates::invalidate);
+    connect(model, &QAbstractItemModel::modelReset, this, &SubtreeAggregates::invalidate);
+}
+
+SubtreeAggregates *SubtreeAggregates::forModel(QAbstractItemModel *model)
+{
+    if (!model)
+        return nullptr;
+
+    SubtreeAggregates *aggregates = model->findChild<SubtreeAggregates *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!aggregates)
+        aggregates = new SubtreeAggregates(model, model);
+    return aggregates;
+}
+
+QAbstractItemModel *SubtreeAggregates::model() const
+{
+    return m_model;
+}
+
+void SubtreeAggregates::setValueRole(int role)
+{
+    if (role == m_valueRole)
+        return;
+    m_valueRole = role;
+    invalidate();
+}
+
+int SubtreeAggregates::valueRole() const
+{
+    return m_valueRole;
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::summary(const QModelIndex &index) const
+{
+    if (!m_model || (index.isValid() && index.model() != m_model))
+        return Summary();
+    if (m_dirty)
+        rebuild();
+    return storedSummary(index);
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::summaryFor(const QModelIndex &index)
+{
+    QModelIndex source = index.sibling(index.row(), 0);
+    while (const QAbstractProxyModel *proxy = qobject_cast<const QAbstractProxyModel *>(source.model()))
+        source = proxy->mapToSource(source);
+    if (!source.isValid())
+        return Summary();
+    return forModel(const_cast<QAbstractItemModel *>(source.model()))->summary(source);
+}
+
+void SubtreeAggregates::rebuild() const
+{
+    m_summaries.clear();
+    m_dirty = false;
+    if (!m_model)
+        return;
+
+    // 按层展开: 同一父节点的子节点在下一层中连续存放, 叶节点在读取时即得到自身的计数.
+    // 模型不是线程安全的, 读取只在当前线程中进行
+    QVector<quint64> ids;
+    QVector<int> firstChild;
+    QVector<int> childCount;
+    QVector<Summary> totals;
+    QVector<int> levelStart;
+
+    QVector<QModelIndex> current;
+    for (int row = 0; row < m_model->rowCount(); ++row)
+        current.append(m_model->index(row, 0));
+
+    while (!current.isEmpty()) {
+        levelStart.append(ids.size());
+        const int levelEnd = ids.size() + current.size();
+        QVector<QModelIndex> next;
+        for (const QModelIndex &node : std::as_const(current)) {
+            const int rowCount = m_model->rowCount(node);
+            ids.append(nodeId(node));
+            firstChild.append(levelEnd + next.size());
+            childCount.append(rowCount);
+            totals.append(ownSummary(node, rowCount == 0));
+            for (int row = 0; row < rowCount; ++row)
+                next.append(m_model->index(row, 0, node));
+        }
+        current.swap(next);
+    }
+    levelStart.append(ids.size());
+
+    // 自底向上逐层求和(加到节点自身的贡献上): 同一层的节点只读下一层、只写自己, 可以分块并行
+    Summary *data = totals.data();
+    const int *first = firstChild.constData();
+    const int *count = childCount.constData();
+    auto reduceRange = [data, first, count](const QPair<int, int> &range) {
+        for (int i = range.first; i < range.second; ++i) {
+            for (int child = first[i]; child < first[i] + count[i]; ++child)
+                data[i] += data[child];
+        }
+    };
+    for (int level = levelStart.size() - 3; level >= 0; --level) {
+        const int begin = levelStart.at(level);
+        const int end = levelStart.at(level + 1);
+        if (end - begin >= MIN_PARALLEL_LEVEL) {
+            QVector<QPair<int, int>> ranges = splitRanges(begin, end);
+            QtConcurrent::blockingMap(ranges, reduceRange);
+        } else {
+            reduceRange(qMakePair(begin, end));
+        }
+    }
+
+    Summary total;
+    for (int i = 0; i < (levelStart.size() > 1 ? levelStart.at(1) : 0); ++i)
+        total += totals.at(i);
+
+    m_summaries.reserve(ids.size() + 1);
+    m_summaries.insert(ROOT_KEY, total);
+    for (int i = 0; i < ids.size(); ++i) {
+        if (ids.at(i) != ROOT_KEY)
+            m_summaries.insert(ids.at(i), totals.at(i));
+    }
+}
+
+int SubtreeAggregates::indexedNodes() const
+{
+    return m_summaries.size();
+}
+
+QString SubtreeAggregates::describe(const Summary &summary)
+{
+    return QString("%1 leaves, %2 checked, sum %3").arg(summary.leafs).arg(summary.checked).arg(summary.sum);
+}
+
+void SubtreeAggregates::reportMemory(MemoryReport &report) const
+{
+    report.add("SubtreeAggregates", "node summaries",
+               quint64(m_summaries.size()) * MemoryReport::hashNodeBytes(sizeof(quint64), sizeof(Summary)),
+               quint64(m_summaries.size()));
+}
+
+quint64 SubtreeAggregates::nodeId(const QModelIndex &index) const
+{
+    return index.isValid() ? index.sibling(index.row(), 0).data(NodeIdRole).toULongLong() : ROOT_KEY;
+}
+
+bool SubtreeAggregates::hasKey(const QModelIndex &index) const
+{
+    return !index.isValid() || nodeId(index) != ROOT_KEY;
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::ownSummary(const QModelIndex &index, bool leaf) const
+{
+    Summary summary;
+    if (!index.isValid())
+        return summary;
+
+    const QModelIndex node = index.sibling(index.row(), 0);
+    summary.checked = node.data(Qt::CheckStateRole).toInt() == Qt::Checked ? 1 : 0;
+    if (leaf) {
+        summary.leafs = 1;
+        summary.sum = node.data(m_valueRole).toDouble();
+    }
+    return summary;
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::subtreeSummary(const QModelIndex &index) const
+{
+    const int rowCount = m_model->rowCount(index);
+    Summary total = ownSummary(index, rowCount == 0);
+    for (int row = 0; row < rowCount; ++row)
+        total += subtreeSummary(m_model->index(row, 0, index));
+    return total;
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::indexSubtree(const QModelIndex &index)
+{
+    const int rowCount = m_model->rowCount(index);
+    Summary total = ownSummary(index, rowCount == 0);
+    for (int row = 0; row < rowCount; ++row)
+        total += indexSubtree(m_model->index(row, 0, index));
+
+    if (hasKey(index))
+        m_summaries.insert(nodeId(index), total);
+    return total;
+}
+
+SubtreeAggregates::Summary SubtreeAggregates::storedSummary(const QModelIndex &index) const
+{
+    if (hasKey(index)) {
+        auto it = m_summaries.constFind(nodeId(index));
+        if (it != m_summaries.constEnd())
+            return it.value();
+    }
+    return subtreeSummary(index);
+}
+
+void SubtreeAggregates::dropSubtree(const QModelIndex &index)
+{
+    const int rowCount = m_model->rowCount(index);
+    for (int row = 0; row < rowCount; ++row)
+        dropSubtree(m_model->index(row, 0, index));
+
+    if (hasKey(index))
+        m_summaries.remove(nodeId(index));
+}
+
+void SubtreeAggregates::addToAncestors(const QModelIndex &node, const Summary &delta)
+{
+    // 从 node 本身一直加到顶层; 没有 ID 的祖先跳过, 查询时递归统计
+    for (QModelIndex ancestor = node;; ancestor = ancestor.parent()) {
+        if (hasKey(ancestor)) {
+            auto it = m_summaries.find(nodeId(ancestor));
+            if (it != m_summaries.end())
+                it.value() += delta;
+        }
+        if (!ancestor.isValid())
+            break;
+    }
+    scheduleChanged();
+}
+
+void SubtreeAggregates::invalidate()
+{
+    m_summaries.clear();
+    m_dirty = true;
+    scheduleChanged();
+}
+
+void SubtreeAggregates::scheduleChanged()
+{
+    // 实时更新每帧可能改动上千个节点, 视图只需要在下一帧之前重绘一次
+    if (m_changePending)
+        return;
+    m_changePending = true;
+    QMetaObject::invokeMethod(this, [this] {
+        m_changePending = false;
+        emit summariesChanged();
+    }, Qt::QueuedConnection);
+}
+
+void SubtreeAggregates::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (m_dirty)
+        return;
+
+    Summary delta;
+    for (int row = first; row <= last; ++row)
+        delta += indexSubtree(m_model->index(row, 0, parent));
+
+    // 父节点原来是叶节点: 它自身不再计为叶节点
+    if (parent.isValid() && m_model->rowCount(parent) == last - first + 1) {
+        delta += ownSummary(parent, false);
+        delta -= ownSummary(parent, true);
+    }
+    addToAncestors(parent, delta);
+}
+
+void SubtreeAggregates::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (m_dirty)
+        return;
+
+    Summary delta;
+    for (int row = first; row <= last; ++row) {
+        const QModelIndex child = m_model->index(row, 0, parent);
+        delta -= storedSummary(child);
+        dropSubtree(child);
+    }
+    addToAncestors(parent, delta);
+}
+
+void SubtreeAggregates::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(first);
+    Q_UNUSED(last);
+    if (m_dirty)
+        return;
+
+    // 父节点的子节点全部删除后它自己成为叶节点
+    if (parent.isValid() && m_model->rowCount(parent) == 0) {
+        Summary delta = ownSummary(parent, true);
+        delta -= ownSummary(parent, false);
+        addToAncestors(parent, delta);
+    }
+}
+
+void SubtreeAggregates::onRowsAboutToBeMoved(const QModelIndex &sourceParent, int start, int end,
+                                             const QModelIndex &destinationParent, int row)
+{
+    Q_UNUSED(destinationParent);
+    Q_UNUSED(row);
+    if (m_dirty)
+        return;
+
+    // 被移动的子树按 ID 保存, 其下各节点的汇总不变; 只需从源端祖先链减去, 移动后加到目标端
+    m_movingSummary = Summary();
+    for (int r = start; r <= end; ++r)
+        m_movingSummary += storedSummary(m_model->index(r, 0, sourceParent));
+
+    Summary delta;
+    delta -= m_movingSummary;
+    addToAncestors(sourceParent, delta);
+}
+
+void SubtreeAggregates::onRowsMoved(const QModelIndex &sourceParent, int start, int end,
+                                    const QModelIndex &destinationParent, int row)
+{
+    Q_UNUSED(row);
+    if (m_dirty)
+        return;
+
+    if (sourceParent.isValid() && m_model->rowCount(sourceParent) == 0) {
+        Summary becameLeaf = ownSummary(sourceParent, true);
+        becameLeaf -= ownSummary(sourceParent, false);
+        addToAncestors(sourceParent, becameLeaf);
+    }
+
+    Summary delta = m_movingSummary;
+    if (destinationParent != sourceParent && destinationParent.isValid()
+            && m_model->rowCount(destinationParent) == end - start + 1) {
+        delta += ownSummary(destinationParent, false);
+        delta -= ownSummary(destinationParent, true);
+    }
+    addToAncestors(destinationParent, delta);
+    m_movingSummary = Summary();
+}
+
+void SubtreeAggregates::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                      const QVector<int> &roles)
+{
+    if (m_dirty || topLeft.column() > 0)
+        return;
+    if (roles.contains(NodeIdRole)) {
+        invalidate();
+        return;
+    }
+    if (!roles.isEmpty() && !roles.contains(Qt::CheckStateRole) && !roles.contains(m_valueRole))
+        return;
+
+    // 节点自身贡献的变化沿祖先链加上去. 旧的贡献 = 保存的子树汇总 - 各子节点的汇总
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex node = topLeft.sibling(row, 0);
+        if (!hasKey(node)) {
+            // 没有 ID 的节点不知道旧值, 只能整体重建
+            invalidate();
+            return;
+        }
+
+        const int rowCount = m_model->rowCount(node);
+        Summary old = m_summaries.value(nodeId(node));
+        for (int child = 0; child < rowCount; ++child)
+            old -= storedSummary(m_model->index(child, 0, node));
+        const Summary now = ownSummary(node, rowCount == 0);
+        if (now == old)
+            continue;
+        Summary delta = now;
+        delta -= old;
+        addToAncestors(node, delta);
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef SUBTREEAGGREGATES_H
+#define SUBTREEAGGREGATES_H
+
+#include <QObject>
+#include <QModelIndex>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+#include "memoryreport.h"
+
+class QAbstractItemModel;
+
+// 子树汇总: 每个节点保存其子树(含自身)的叶节点数、勾选的节点数(任意层级)和叶节点数值之和
+// 汇总按稳定 ID(NodeIdRole)保存, 顶层(整个模型)为 0; 查询是一次散列查找, 与子树规模无关.
+// 插入、删除、移动和节点的数据变化只沿祖先链加减差值(O(深度)), 新增的子树自身需要完整统计一次;
+// 布局变化和重置后在下次查询时整体重建. 首次建立时在 GUI 线程中逐层读取模型, 逐层自底向上的求和并行执行.
+// 没有 ID 的节点不保存汇总, 查询到它时退化为递归统计
+class SubtreeAggregates : public QObject, public MemoryReporter
+{
+    Q_OBJECT
+
+public:
+    struct Summary {
+        qint64 leafs = 0;      // 没有子节点的节点数(叶节点本身计 1)
+        qint64 checked = 0;    // 勾选的节点数, 各层级的节点都计入
+        double sum = 0.0;      // 叶节点数值角色之和
+
+        Summary &operator+=(const Summary &other);
+        Summary &operator-=(const Summary &other);
+        bool operator==(const Summary &other) const;
+        bool operator!=(const Summary &other) const { return !(*this == other); }
+    };
+
+    explicit SubtreeAggregates(QAbstractItemModel *model, QObject *parent = nullptr);
+
+    // 该模型共用的汇总, 首次调用时创建为模型的子对象, 随模型一起销毁
+    static SubtreeAggregates *forModel(QAbstractItemModel *model);
+
+    QAbstractItemModel *model() const;
+
+    // 求和的数值角色, 默认 NodeValueRole; 修改后在下次查询时重建
+    void setValueRole(int role);
+    int valueRole() const;
+
+    // index 所在子树的汇总, 无效索引返回整个模型的汇总
+    Summary summary(const QModelIndex &index) const;
+    // 视图侧的便捷入口: 经代理映射到源模型后查询源模型共用的汇总, 任意列都按所在行的节点统计
+    static Summary summaryFor(const QModelIndex &index);
+
+    // 立即建立汇总(默认在首次查询时建立)
+    void rebuild() const;
+    int indexedNodes() const;
+
+    // "12 leaves, 4 checked, sum 37.5", 详情对话框与提示共用
+    static QString describe(const Summary &summary);
+
+    void reportMemory(MemoryReport &report) const override;
+
+signals:
+    // 增量更新改变了某些汇总, 或汇总失效待重建; 显示汇总的视图据此重绘.
+    // 同一轮事件循环中的多次变化合并成一次, 在回到事件循环后发出
+    void summariesChanged();
+
+private:
+    quint64 nodeId(const QModelIndex &index) const;
+    bool hasKey(const QModelIndex &index) const;
+    // 节点自身的贡献: 勾选状态总是计入, 叶节点计数和数值只在 leaf 为 true 时计入
+    Summary ownSummary(const QModelIndex &index, bool leaf) const;
+    Summary subtreeSummary(const QModelIndex &index) const;
+    Summary indexSubtree(const QModelIndex &index);
+    Summary storedSummary(const QModelIndex &index) const;
+    void dropSubtree(const QModelIndex &index);
+    void addToAncestors(const QModelIndex &node, const Summary &delta);
+    void invalidate();
+    void scheduleChanged();
+
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeMoved(const QModelIndex &sourceParent, int start, int end,
+                              const QModelIndex &destinationParent, int row);
+    void onRowsMoved(const QModelIndex &sourceParent, int start, int end,
+                     const QModelIndex &destinationParent, int row);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+    QPointer<QAbstractItemModel> m_model;
+    int m_valueRole;
+    mutable QHash<quint64, Summary> m_summaries;
+    mutable bool m_dirty = true;
+    bool m_changePending = false;   // summariesChanged 已排队, 尚未发出
+    Summary m_movingSummary;   // rowsAboutToBeMoved 与 rowsMoved 之间被移动的子树之和
+};
+
+#endif // SUBTREEAGGREGATES_H
@@ -0,0 +1,44 @@
+#ifndef SUMMARYDELEGATE_H
+#define SUMMARYDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QApplication>
+#include <QPainter>
+#include "subtreeaggregates.h"
+
+// 附加列的代理: 显示该行节点子树的"勾选节点数/叶节点数"和叶节点数值之和.
+// 汇总按节点查表, 不随子树规模变化; 模型的附加列只提供 NodeIdRole, 文本由这里生成
+class SummaryDelegate : public QStyledItemDelegate {
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    static QString summaryText(const QModelIndex &index) {
+        const SubtreeAggregates::Summary summary = SubtreeAggregates::summaryFor(index);
+        QString text = QString("%1/%2").arg(summary.checked).arg(summary.leafs);
+        if (summary.sum != 0.0)
+            text += QString("  Σ %1").arg(summary.sum);
+        return text;
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        QStyleOptionViewItem opt = option;
+        initStyleOption(&opt, index);
+        opt.text.clear();
+        QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+        style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+        painter->save();
+        painter->setPen(opt.palette.color(opt.state.testFlag(QStyle::State_Selected)
+                                          ? QPalette::HighlightedText : QPalette::Text));
+        painter->drawText(opt.rect.adjusted(4, 0, -4, 0), Qt::AlignRight | Qt::AlignVCenter,
+                          opt.fontMetrics.elidedText(summaryText(index), Qt::ElideLeft, opt.rect.width() - 8));
+        painter->restore();
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        // 行高由第 0 列的叶节点按钮决定, 这里只给出文本高度
+        return QSize(option.fontMetrics.horizontalAdvance(summaryText(index)) + 8, option.fontMetrics.height() + 4);
+    }
+};
+
+#endif // SUMMARYDELEGATE_H
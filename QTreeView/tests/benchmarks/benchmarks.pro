@@ -0,0 +1,59 @@
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_treebenchmarks
+
+# 被测代码直接取自上级工程
+INCLUDEPATH += ../..
+
+perf_counters: DEFINES += LEAFTREE_PERF_COUNTERS
+
+SOURCES += \
+    ../../leafbuttonaccessible.cpp \
+    ../../leafbuttondelegate.cpp \
+    ../../leafmove.cpp \
+    ../../leafsortproxymodel.cpp \
+    ../../leaftreemodel.cpp \
+    ../../leafstrip.cpp \
+    ../../livefeedgenerator.cpp \
+    ../../liveupdatequeue.cpp \
+    ../../memoryreport.cpp \
+    ../../modelprofiler.cpp \
+    ../../pathindex.cpp \
+    ../../perfcounters.cpp \
+    ../../rowtilerenderer.cpp \
+    ../../sessionrecorder.cpp \
+    ../../sessionreplayer.cpp \
+    ../../subtreeaggregates.cpp \
+    ../../treeviewstate.cpp \
+    benchreport.cpp \
+    synthetictree.cpp \
+    tst_treebenchmarks.cpp
+
+HEADERS += \
+    ../../dynamictreeview.h \
+    ../../leafbuttonaccessible.h \
+    ../../leafbuttondelegate.h \
+    ../../leafmove.h \
+    ../../leafsortproxymodel.h \
+    ../../leaftreemodel.h \
+    ../../leafstrip.h \
+    ../../livefeedgenerator.h \
+    ../../liveupdatequeue.h \
+    ../../memoryreport.h \
+    ../../modelprofiler.h \
+    ../../pathindex.h \
+    ../../mpscqueue.h \
+    ../../perfcounters.h \
+    ../../rowtilerenderer.h \
+    ../../sessionrecorder.h \
+    ../../sessionreplayer.h \
+    ../../subtreeaggregates.h \
+    ../../treeroles.h \
+    ../../treeviewstate.h \
+    benchreport.h \
+    synthetictree.h
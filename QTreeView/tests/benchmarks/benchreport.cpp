@@ -0,0 +1,76 @@
+#include "benchreport.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+void BenchReport::record(const QString &benchmark, const QString &tag, qint64 totalNs, qint64 iterations)
+{
+    if (iterations <= 0)
+        return;
+
+    Entry entry;
+    entry.benchmark = benchmark;
+    entry.tag = tag;
+    entry.metric = "nsPerIteration";
+    entry.value = double(totalNs) / double(iterations);
+    entry.iterations = iterations;
+    m_entries.append(entry);
+}
+
+void BenchReport::recordValue(const QString &benchmark, const QString &tag, const QString &metric, double value)
+{
+    Entry entry;
+    entry.benchmark = benchmark;
+    entry.tag = tag;
+    entry.metric = metric;
+    entry.value = value;
+    m_entries.append(entry);
+}
+
+bool BenchReport::write(const QString &baseName) const
+{
+    const QString dirPath = qEnvironmentVariableIsSet("BENCH_OUTPUT_DIR")
+            ? qEnvironmentVariable("BENCH_OUTPUT_DIR")
+            : QDir::currentPath();
+    QDir dir(dirPath);
+    if (!dir.exists() && !dir.mkpath("."))
+        return false;
+
+    QFile csvFile(dir.filePath(baseName + ".csv"));
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream csv(&csvFile);
+    csv << "benchmark,tag,metric,value,iterations\n";
+    for (const Entry &entry : m_entries) {
+        csv << entry.benchmark << ',' << entry.tag << ',' << entry.metric << ','
+            << QString::number(entry.value, 'f', 1) << ',' << entry.iterations << '\n';
+    }
+
+    QJsonArray results;
+    for (const Entry &entry : m_entries) {
+        QJsonObject object;
+        object["benchmark"] = entry.benchmark;
+        object["tag"] = entry.tag;
+        object["metric"] = entry.metric;
+        object["value"] = entry.value;
+        object["iterations"] = double(entry.iterations);
+        results.append(object);
+    }
+
+    QJsonObject root;
+    root["commit"] = qEnvironmentVariable("BENCH_COMMIT");
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qtVersion"] = QString(qVersion());
+    root["results"] = results;
+
+    QFile jsonFile(dir.filePath(baseName + ".json"));
+    if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
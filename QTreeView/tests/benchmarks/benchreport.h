@@ -0,0 +1,33 @@
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include <QString>
+#include <QVector>
+
+// 收集每个基准的平均耗时及其他指标, 并写出 CSV/JSON 便于跨提交对比
+// 输出目录由 BENCH_OUTPUT_DIR 指定(默认当前目录), BENCH_COMMIT 会写入 JSON 头部
+class BenchReport
+{
+public:
+    // 记录平均单次耗时, 指标名为 nsPerIteration
+    void record(const QString &benchmark, const QString &tag, qint64 totalNs, qint64 iterations);
+
+    // 记录任意数值指标(调用次数、字节数等)
+    void recordValue(const QString &benchmark, const QString &tag, const QString &metric, double value);
+
+    // 写出 <baseName>.csv 与 <baseName>.json
+    bool write(const QString &baseName) const;
+
+private:
+    struct Entry {
+        QString benchmark;
+        QString tag;
+        QString metric;
+        double value = 0.0;
+        qint64 iterations = 0;
+    };
+
+    QVector<Entry> m_entries;
+};
+
+#endif // BENCHREPORT_H
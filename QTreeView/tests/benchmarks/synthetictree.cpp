@@ -0,0 +1,82 @@
+#include "synthetictree.h"
+#include "treeroles.h"
+
+int syntheticSubtreeSize(const SyntheticTreeShape &shape)
+{
+    return 1 + shape.childrenPerRoot * (1 + shape.leafsPerChild);
+}
+
+QStandardItemModel *buildSyntheticTree(int nodeCount, QObject *parent, const SyntheticTreeShape &shape)
+{
+    QStandardItemModel *model = new QStandardItemModel(parent);
+    model->setHorizontalHeaderLabels({"Dynamic Content"});
+
+    const int rootCount = qMax(1, nodeCount / syntheticSubtreeSize(shape));
+
+    // 节点 ID 按创建顺序从 1 开始分配
+    quint64 nextId = 1;
+
+    // 先在内存中组装整棵子树再一次性挂到模型上, 避免逐行发出 rowsInserted
+    QList<QStandardItem *> roots;
+    roots.reserve(rootCount);
+    for (int i = 1; i <= rootCount; ++i) {
+        QStandardItem *root = new QStandardItem(QString("Root %1").arg(i));
+        root->setCheckable(true);
+        root->setEditable(false);
+        root->setData(QVariant::fromValue<quint64>(nextId++), NodeIdRole);
+
+        QList<QStandardItem *> children;
+        children.reserve(shape.childrenPerRoot);
+        for (int j = 1; j <= shape.childrenPerRoot; ++j) {
+            QStandardItem *child = new QStandardItem(QString("Child %1-%2").arg(i).arg(j));
+            child->setCheckable(true);
+            child->setEditable(false);
+            child->setData(QVariant::fromValue<quint64>(nextId++), NodeIdRole);
+
+            QList<QStandardItem *> leafs;
+            leafs.reserve(shape.leafsPerChild);
+            for (int k = 1; k <= shape.leafsPerChild; ++k) {
+                QStandardItem *leaf = new QStandardItem(QString("Leaf %1-%2-%3").arg(i).arg(j).arg(k));
+                leaf->setEditable(false);
+                leaf->setData(QVariant::fromValue<quint64>(nextId++), NodeIdRole);
+                leafs.append(leaf);
+            }
+            child->appendRows(leafs);
+            children.append(child);
+        }
+        root->appendRows(children);
+        roots.append(root);
+    }
+
+    QStandardItem *invisibleRoot = model->invisibleRootItem();
+    invisibleRoot->appendRows(roots);
+    return model;
+}
+
+LeafTreeModel::Snapshot buildSyntheticSnapshot(int nodeCount, const SyntheticTreeShape &shape)
+{
+    const int rootCount = qMax(1, nodeCount / syntheticSubtreeSize(shape));
+
+    LeafTreeModel::Snapshot snapshot;
+    snapshot.nodes.reserve(rootCount * syntheticSubtreeSize(shape));
+
+    auto addNode = [&snapshot](quint64 parentId, const QString &text, bool checkable) {
+        LeafTreeModel::Snapshot::Node node;
+        node.id = quint64(snapshot.nodes.size()) + 1;
+        node.parentId = parentId;
+        node.text = text;
+        node.checkable = checkable;
+        snapshot.nodes.append(node);
+        return node.id;
+    };
+
+    for (int i = 1; i <= rootCount; ++i) {
+        const quint64 rootId = addNode(0, QString("Root %1").arg(i), true);
+        for (int j = 1; j <= shape.childrenPerRoot; ++j) {
+            const quint64 childId = addNode(rootId, QString("Child %1-%2").arg(i).arg(j), true);
+            for (int k = 1; k <= shape.leafsPerChild; ++k)
+                addNode(childId, QString("Leaf %1-%2-%3").arg(i).arg(j).arg(k), false);
+        }
+    }
+    return snapshot;
+}
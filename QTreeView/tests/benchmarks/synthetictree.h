@@ -0,0 +1,23 @@
+#ifndef SYNTHETICTREE_H
+#define SYNTHETICTREE_H
+
+#include <QStandardItemModel>
+#include "leaftreemodel.h"
+
+// 合成树的形状: 与 MainWindow::setupModel 相同的 Root > Child > Leaf 三级结构
+struct SyntheticTreeShape {
+    int childrenPerRoot = 16;
+    int leafsPerChild = 8;
+};
+
+// 每个根节点子树包含的节点数(根 + 子节点 + 叶节点)
+int syntheticSubtreeSize(const SyntheticTreeShape &shape = SyntheticTreeShape());
+
+// 生成大约 nodeCount 个节点的树, 至少包含一个根节点; 每个节点带有 NodeIdRole
+QStandardItemModel *buildSyntheticTree(int nodeCount, QObject *parent = nullptr,
+                                       const SyntheticTreeShape &shape = SyntheticTreeShape());
+
+// 同样形状的层级快照, 节点 ID 的分配与 buildSyntheticTree 一致
+LeafTreeModel::Snapshot buildSyntheticSnapshot(int nodeCount, const SyntheticTreeShape &shape = SyntheticTreeShape());
+
+#endif // SYNTHETICTREE_H
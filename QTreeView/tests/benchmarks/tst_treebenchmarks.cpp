@@ -0,0 +1,1268 @@
+#include <QtTest>
+#include <QApplication>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QStandardItemModel>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "leafbuttondelegate.h"
+#include "dynamictreeview.h"
+#include "memoryreport.h"
+#include "modelprofiler.h"
+#include "pathindex.h"
+#include "leafmove.h"
+#include "leafsortproxymodel.h"
+#include "leaftreemodel.h"
+#include "rowtilerenderer.h"
+#include "sessionrecorder.h"
+#include "sessionreplayer.h"
+#include "subtreeaggregates.h"
+#include "liveupdatequeue.h"
+#include "livefeedgenerator.h"
+#include "perfcounters.h"
+#include "treeroles.h"
+#include "treeviewstate.h"
+#include "benchreport.h"
+#include "synthetictree.h"
+
+// 计时包装: QBENCHMARK 会多次执行循环体, 这里统计总耗时和实际迭代次数写入报告
+#define TREE_BENCHMARK(body) \
+    do { \
+        QElapsedTimer treeBenchTimer_; \
+        qint64 treeBenchIterations_ = 0; \
+        treeBenchTimer_.start(); \
+        QBENCHMARK { body; ++treeBenchIterations_; } \
+        recordResult(treeBenchTimer_.nsecsElapsed(), treeBenchIterations_); \
+    } while (0)
+
+#define TREE_BENCHMARK_ONCE(body) \
+    do { \
+        QElapsedTimer treeBenchTimer_; \
+        treeBenchTimer_.start(); \
+        QBENCHMARK_ONCE { body; } \
+        recordResult(treeBenchTimer_.nsecsElapsed(), 1); \
+    } while (0)
+
+class TreeBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void delegatePaint_data() { sizeData(); }
+    void delegatePaint();
+    void viewportPaint_data() { sizeData(); }
+    void viewportPaint();
+    void hoverReplay_data() { sizeData(); }
+    void hoverReplay();
+    void mouseMoveCoalescing();
+    void delegateSizeHint_data() { sizeData(); }
+    void delegateSizeHint();
+    void visibleRowCount_data() { sizeData(); }
+    void visibleRowCount();
+    void expandAll_data() { sizeData(); }
+    void expandAll();
+    void bulkDelete_data() { sizeData(); }
+    void bulkDelete();
+    void modelDataCallsPerFrame_data() { sizeData(); }
+    void modelDataCallsPerFrame();
+    void scrollFrames_data();
+    void scrollFrames();
+    void coldScroll_data();
+    void coldScroll();
+    void stripScroll();
+    void liveUpdates_data();
+    void liveUpdates();
+    void restoreViewState_data() { sizeData(); }
+    void restoreViewState();
+    void sortProxy_data() { sizeData(); }
+    void sortProxy();
+    void pathLookup_data() { sizeData(); }
+    void pathLookup();
+    void memoryFootprint_data() { sizeData(); }
+    void memoryFootprint();
+    void snapshotApply_data() { sizeData(); }
+    void snapshotApply();
+    void leafMove_data() { sizeData(); }
+    void leafMove();
+    void subtreeAggregates_data() { sizeData(); }
+    void subtreeAggregates();
+    void sessionReplay_data() { sizeData(); }
+    void sessionReplay();
+
+private:
+    struct BenchSize { const char *tag; int nodes; };
+    static QVector<BenchSize> benchSizes();
+    void sizeData();
+    void recordResult(qint64 totalNs, qint64 iterations);
+    void recordFrameStats(const QString &benchmark, const QString &tag, QVector<qint64> frameNs);
+    QStandardItemModel *cachedModel(int nodeCount);
+    std::unique_ptr<DynamicTreeView> createView(QAbstractItemModel *model, bool expandEverything);
+    QStyleOptionViewItem optionFor(const DynamicTreeView *view, const QModelIndex &index) const;
+    QModelIndexList visibleChildRows(const DynamicTreeView *view) const;
+    static SubtreeAggregates::Summary recursiveSummary(const QAbstractItemModel *model, const QModelIndex &index);
+
+    LeafButtonDelegate *m_delegate = nullptr;
+    QMap<int, QStandardItemModel *> m_models;
+    BenchReport m_report;
+};
+
+void TreeBenchmarks::initTestCase()
+{
+    m_delegate = new LeafButtonDelegate(this);
+}
+
+void TreeBenchmarks::cleanupTestCase()
+{
+    qDeleteAll(m_models);
+    m_models.clear();
+
+    if (!m_report.write("tree_benchmarks"))
+        qWarning() << "Failed to write benchmark report";
+}
+
+QVector<TreeBenchmarks::BenchSize> TreeBenchmarks::benchSizes()
+{
+    // BENCH_MAX_NODES 可限制最大规模, 便于在慢机器上快速跑一遍
+    const int maxNodes = qEnvironmentVariableIsSet("BENCH_MAX_NODES")
+            ? qEnvironmentVariableIntValue("BENCH_MAX_NODES")
+            : 1000000;
+
+    const BenchSize sizes[] = {
+        { "1k", 1000 }, { "10k", 10000 }, { "100k", 100000 }, { "1M", 1000000 }
+    };
+    QVector<BenchSize> result;
+    for (const BenchSize &size : sizes) {
+        if (size.nodes <= maxNodes)
+            result.append(size);
+    }
+    return result;
+}
+
+void TreeBenchmarks::sizeData()
+{
+    QTest::addColumn<int>("nodeCount");
+
+    for (const BenchSize &size : benchSizes())
+        QTest::newRow(size.tag) << size.nodes;
+}
+
+void TreeBenchmarks::recordResult(qint64 totalNs, qint64 iterations)
+{
+    m_report.record(QTest::currentTestFunction(), QTest::currentDataTag(), totalNs, iterations);
+}
+
+// 逐帧耗时的平均、p95 和最大值
+void TreeBenchmarks::recordFrameStats(const QString &benchmark, const QString &tag, QVector<qint64> frameNs)
+{
+    std::sort(frameNs.begin(), frameNs.end());
+    qint64 totalNs = 0;
+    for (qint64 ns : std::as_const(frameNs))
+        totalNs += ns;
+
+    m_report.recordValue(benchmark, tag, "meanFrameMs", totalNs / 1e6 / frameNs.size());
+    m_report.recordValue(benchmark, tag, "p95FrameMs", frameNs.at(int(frameNs.size() * 0.95)) / 1e6);
+    m_report.recordValue(benchmark, tag, "maxFrameMs", frameNs.last() / 1e6);
+}
+
+QStandardItemModel *TreeBenchmarks::cachedModel(int nodeCount)
+{
+    auto it = m_models.find(nodeCount);
+    if (it == m_models.end())
+        it = m_models.insert(nodeCount, buildSyntheticTree(nodeCount));
+    return it.value();
+}
+
+std::unique_ptr<DynamicTreeView> TreeBenchmarks::createView(QAbstractItemModel *model, bool expandEverything)
+{
+    std::unique_ptr<DynamicTreeView> view(new DynamicTreeView);
+    view->setHeaderHidden(true);
+    view->setItemDelegate(m_delegate);
+    view->setModel(model);
+    view->resize(800, 600);
+
+    if (expandEverything) {
+        view->expandAll();
+    } else {
+        // 只展开填满一屏所需的根节点, 绘制开销不应随整棵树的规模变化
+        const int roots = qMin(model->rowCount(), 3);
+        for (int i = 0; i < roots; ++i)
+            view->expandRecursively(model->index(i, 0));
+    }
+
+    view->show();
+    if (!QTest::qWaitForWindowExposed(view.get()))
+        qWarning() << "View was not exposed";
+    return view;
+}
+
+QStyleOptionViewItem TreeBenchmarks::optionFor(const DynamicTreeView *view, const QModelIndex &index) const
+{
+    QStyleOptionViewItem option;
+    option.initFrom(view->viewport());
+    option.rect = view->visualRect(index);
+    option.font = view->font();
+    option.fontMetrics = view->fontMetrics();
+    return option;
+}
+
+QModelIndexList TreeBenchmarks::visibleChildRows(const DynamicTreeView *view) const
+{
+    // 收集视口内带叶节点按钮的子节点行
+    QModelIndexList rows;
+    const QRect viewportRect = view->viewport()->rect();
+    for (QModelIndex index = view->indexAt(QPoint(1, 1)); index.isValid(); index = view->indexBelow(index)) {
+        const QRect rect = view->visualRect(index);
+        if (!rect.intersects(viewportRect))
+            break;
+        if (index.parent().isValid() && view->model()->hasChildren(index))
+            rows.append(index);
+    }
+    return rows;
+}
+
+void TreeBenchmarks::delegatePaint()
+{
+    QFETCH(int, nodeCount);
+
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+    const QModelIndexList rows = visibleChildRows(view.get());
+    QVERIFY(!rows.isEmpty());
+
+    QVector<QStyleOptionViewItem> options;
+    options.reserve(rows.size());
+    for (const QModelIndex &index : rows)
+        options.append(optionFor(view.get(), index));
+
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+
+    TREE_BENCHMARK(
+        for (int i = 0; i < rows.size(); ++i)
+            m_delegate->paint(&painter, options.at(i), rows.at(i));
+    );
+}
+
+void TreeBenchmarks::viewportPaint()
+{
+    QFETCH(int, nodeCount);
+
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+
+    TREE_BENCHMARK(
+        image.fill(Qt::white);
+        view->viewport()->render(&image);
+    );
+}
+
+void TreeBenchmarks::hoverReplay()
+{
+    QFETCH(int, nodeCount);
+
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+
+    // 先绘制一次以建立叶节点按钮的布局缓存
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view->viewport()->render(&image);
+
+    struct HoverStep {
+        QPersistentModelIndex index;
+        QStyleOptionViewItem option;
+        std::shared_ptr<QMouseEvent> event;
+    };
+
+    // 沿每一行从左到右扫过, 模拟鼠标在叶节点按钮之间移动
+    std::vector<HoverStep> steps;
+    const QModelIndexList rows = visibleChildRows(view.get());
+    for (const QModelIndex &index : rows) {
+        const QStyleOptionViewItem option = optionFor(view.get(), index);
+        for (int x = option.rect.left(); x < option.rect.right(); x += 8) {
+            const QPoint pos(x, option.rect.center().y());
+            steps.push_back({ index, option,
+                              std::make_shared<QMouseEvent>(QEvent::MouseMove, pos,
+                                                            view->viewport()->mapToGlobal(pos), Qt::NoButton,
+                                                            Qt::NoButton, Qt::NoModifier) });
+        }
+    }
+    QVERIFY(!steps.empty());
+
+    QAbstractItemModel *model = view->model();
+    TREE_BENCHMARK(
+        for (const HoverStep &step : steps)
+            m_delegate->editorEvent(step.event.get(), model, step.option, step.index);
+    );
+}
+
+void TreeBenchmarks::mouseMoveCoalescing()
+{
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(1000), false);
+
+    // 沿可见的子节点行扫过叶节点按钮的位置
+    QVector<QPoint> positions;
+    for (const QModelIndex &index : visibleChildRows(view.get())) {
+        const QRect rect = view->visualRect(index);
+        for (int x = rect.left(); x < rect.right(); x += 4)
+            positions.append(QPoint(x, rect.center().y()));
+    }
+    QVERIFY(!positions.isEmpty());
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+
+    // 约 1000Hz 的鼠标: 每毫秒一个移动事件, 持续 500ms, 分别在合并关闭和打开时统计
+    QVector<DynamicTreeView::MouseMoveStats> results;
+    for (bool coalescing : { false, true }) {
+        view->setMouseMoveCoalescing(coalescing);
+        const DynamicTreeView::MouseMoveStats before = view->mouseMoveStats();
+
+        QElapsedTimer clock;
+        clock.start();
+        for (int step = 0; clock.elapsed() < 500; ++step) {
+            const QPoint pos = positions.at(step % positions.size());
+            QMouseEvent move(QEvent::MouseMove, pos, view->viewport()->mapToGlobal(pos),
+                             Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+            QApplication::sendEvent(view->viewport(), &move);
+            QTest::qWait(1);
+        }
+        view->flushPendingMouseMove();
+        const double seconds = clock.nsecsElapsed() / 1e9;
+
+        DynamicTreeView::MouseMoveStats delta;
+        delta.received = view->mouseMoveStats().received - before.received;
+        delta.dispatched = view->mouseMoveStats().dispatched - before.dispatched;
+        results.append(delta);
+
+        const QString tag = coalescing ? "coalesced" : "direct";
+        m_report.recordValue(benchmark, tag, "receivedPerSecond", delta.received / seconds);
+        m_report.recordValue(benchmark, tag, "dispatchedPerSecond", delta.dispatched / seconds);
+    }
+    QCOMPARE(results.at(0).dispatched, results.at(0).received);
+    QVERIFY(results.at(1).dispatched < results.at(1).received);
+
+    // 挂起的移动必须在点击之前派发; 点在行尾空白处, 不触发复选框和叶节点按钮
+    const QModelIndex row = visibleChildRows(view.get()).first();
+    const QPoint pos(view->visualRect(row).right() - 2, view->visualRect(row).center().y());
+    for (int i = 0; i < 2; ++i) {
+        QMouseEvent move(QEvent::MouseMove, pos, view->viewport()->mapToGlobal(pos),
+                         Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        QApplication::sendEvent(view->viewport(), &move);
+    }
+    const quint64 dispatchedBeforeClick = view->mouseMoveStats().dispatched;
+    QMouseEvent press(QEvent::MouseButtonPress, pos, view->viewport()->mapToGlobal(pos),
+                      Qt::LeftButton, Qt::LeftButton, Qt::NoModifier);
+    QApplication::sendEvent(view->viewport(), &press);
+    QCOMPARE(view->mouseMoveStats().dispatched, dispatchedBeforeClick + 1);
+    QMouseEvent release(QEvent::MouseButtonRelease, pos, view->viewport()->mapToGlobal(pos),
+                        Qt::LeftButton, Qt::NoButton, Qt::NoModifier);
+    QApplication::sendEvent(view->viewport(), &release);
+}
+
+void TreeBenchmarks::delegateSizeHint()
+{
+    QFETCH(int, nodeCount);
+
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+    QModelIndexList indexes;
+    for (QModelIndex index = view->model()->index(0, 0); index.isValid(); index = view->indexBelow(index))
+        indexes.append(index);
+
+    const QStyleOptionViewItem option = optionFor(view.get(), indexes.first());
+    TREE_BENCHMARK(
+        for (const QModelIndex &index : indexes)
+            m_delegate->sizeHint(option, index);
+    );
+}
+
+void TreeBenchmarks::visibleRowCount()
+{
+    QFETCH(int, nodeCount);
+
+    // DynamicTreeView::sizeHint 会递归统计所有已展开的行
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), true);
+    TREE_BENCHMARK(
+        view->sizeHint();
+    );
+}
+
+void TreeBenchmarks::expandAll()
+{
+    QFETCH(int, nodeCount);
+
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+    TREE_BENCHMARK(
+        view->collapseAll();
+        view->expandAll();
+    );
+}
+
+void TreeBenchmarks::bulkDelete()
+{
+    QFETCH(int, nodeCount);
+
+    // 删除会破坏模型, 每次使用新生成的树
+    std::unique_ptr<QStandardItemModel> model(buildSyntheticTree(nodeCount));
+    std::unique_ptr<DynamicTreeView> view = createView(model.get(), true);
+
+    // 与 MainWindow::onLeafDeleted 相同: 逐个叶节点调用 removeRow
+    TREE_BENCHMARK_ONCE(
+        for (int r = model->rowCount() - 1; r >= 0; --r) {
+            QStandardItem *root = model->item(r);
+            for (int c = root->rowCount() - 1; c >= 0; --c) {
+                QStandardItem *child = root->child(c);
+                for (int l = child->rowCount() - 1; l >= 0; --l)
+                    child->removeRow(l);
+            }
+        }
+    );
+
+    view.reset();
+}
+
+void TreeBenchmarks::modelDataCallsPerFrame()
+{
+    QFETCH(int, nodeCount);
+
+    ModelProfiler profiler;
+    profiler.setSourceModel(cachedModel(nodeCount));
+    std::unique_ptr<DynamicTreeView> view = createView(&profiler, false);
+
+    // 第一帧建立代理的角色缓存, 之后的帧只应产生很少的 data() 调用
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    const struct { const char *name; int frames; } phases[] = { { "coldFrame", 1 }, { "warmFrame", 10 } };
+    for (const auto &phase : phases) {
+        profiler.endFrame();
+        const ModelProfiler::RoleCounts before = profiler.totals();
+        for (int i = 0; i < phase.frames; ++i)
+            view->viewport()->render(&image);
+        const ModelProfiler::RoleCounts after = profiler.totals();
+
+        for (auto it = after.constBegin(); it != after.constEnd(); ++it) {
+            const double perFrame = double(it.value() - before.value(it.key())) / phase.frames;
+            const QString benchmark = QString::fromLatin1(QTest::currentTestFunction())
+                    + '.' + QString::fromLatin1(phase.name);
+            m_report.recordValue(benchmark, QTest::currentDataTag(), ModelProfiler::roleName(it.key()), perFrame);
+        }
+    }
+    qDebug() << profiler.summary();
+}
+
+void TreeBenchmarks::scrollFrames_data()
+{
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<bool>("tiles");
+
+    for (const BenchSize &size : benchSizes()) {
+        QTest::newRow(QByteArray(size.tag).append("/sync").constData()) << size.nodes << false;
+        QTest::newRow(QByteArray(size.tag).append("/tiles").constData()) << size.nodes << true;
+    }
+}
+
+void TreeBenchmarks::scrollFrames()
+{
+    QFETCH(int, nodeCount);
+    QFETCH(bool, tiles);
+
+    if (tiles && !RowTileRenderer::canRenderAsync())
+        QSKIP("Threaded font rendering is not supported on this platform");
+
+    RowTileRenderer renderer;
+    m_delegate->setTileRenderer(tiles ? &renderer : nullptr);
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), true);
+
+    // 模拟滚轮: 每帧向下滚动 3 行; 帧与帧之间的空闲时间里让预取和工作线程完成
+    const int frames = 200;
+    const int rowsPerFrame = 3;
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    QVector<qint64> frameNs;
+    frameNs.reserve(frames);
+
+    for (int frame = 0; frame < frames && scrollBar->value() < scrollBar->maximum(); ++frame) {
+        QCoreApplication::processEvents();
+        if (tiles)
+            renderer.waitForIdle();
+
+        scrollBar->setValue(scrollBar->value() + rowsPerFrame * scrollBar->singleStep());
+
+        QElapsedTimer timer;
+        timer.start();
+        view->viewport()->repaint();
+        frameNs.append(timer.nsecsElapsed());
+    }
+    m_delegate->setTileRenderer(nullptr);
+    QVERIFY(!frameNs.isEmpty());
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    recordFrameStats(benchmark, tag, frameNs);
+    if (tiles) {
+        const quint64 lookups = renderer.hits() + renderer.misses();
+        m_report.recordValue(benchmark, tag, "tileHitRatio", lookups ? double(renderer.hits()) / lookups : 0.0);
+    }
+}
+
+void TreeBenchmarks::coldScroll_data()
+{
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<bool>("prefetch");
+
+    for (const BenchSize &size : benchSizes()) {
+        QTest::newRow(QByteArray(size.tag).append("/off").constData()) << size.nodes << false;
+        QTest::newRow(QByteArray(size.tag).append("/on").constData()) << size.nodes << true;
+    }
+}
+
+void TreeBenchmarks::coldScroll()
+{
+    QFETCH(int, nodeCount);
+    QFETCH(bool, prefetch);
+
+    // 每次用新建的模型, 代理中没有任何行的缓存; 每帧滚动半屏, 新滚入的行都是冷的
+    std::unique_ptr<QStandardItemModel> model(buildSyntheticTree(nodeCount));
+    std::unique_ptr<DynamicTreeView> view = createView(model.get(), true);
+    view->setIdlePrefetchEnabled(prefetch);
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view->viewport()->render(&image);
+
+    const int frames = 100;
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    const int step = qMax(1, scrollBar->pageStep() / 2);
+    QVector<qint64> frameNs;
+    frameNs.reserve(frames);
+
+    for (int frame = 0; frame < frames && scrollBar->value() < scrollBar->maximum(); ++frame) {
+        scrollBar->setValue(scrollBar->value() + step);
+
+        QElapsedTimer timer;
+        timer.start();
+        view->viewport()->render(&image);
+        frameNs.append(timer.nsecsElapsed());
+
+        // 帧间的空闲时间, 预取在这里运行
+        QTest::qWait(5);
+    }
+    QVERIFY(!frameNs.isEmpty());
+
+    const DynamicTreeView::PrefetchStats stats = view->prefetchStats();
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    recordFrameStats(benchmark, tag, frameNs);
+    m_report.recordValue(benchmark, tag, "warmedRows", double(stats.warmedRows));
+    m_report.recordValue(benchmark, tag, "prefetchSlices", double(stats.slices));
+    if (prefetch)
+        QVERIFY(stats.warmedRows > 0);
+    else
+        QCOMPARE(stats.warmedRows, quint64(0));
+}
+
+void TreeBenchmarks::stripScroll()
+{
+    // 一个子节点下有 10k 个叶节点并全部翻页显示, 按钮条逐帧水平滚动到末尾;
+    // 每帧只应布局并绘制可见的几个按钮, 帧时间与叶节点总数无关
+    const int leafCount = 10000;
+    QStandardItemModel model;
+    QStandardItem *root = new QStandardItem("Root 1");
+    QStandardItem *child = new QStandardItem("Child 1-1");
+    QList<QStandardItem *> leafs;
+    for (int i = 1; i <= leafCount; ++i)
+        leafs.append(new QStandardItem(QString("Leaf 1-1-%1").arg(i)));
+    child->appendRows(leafs);
+    root->appendRow(child);
+    model.appendRow(root);
+
+    // 用单独的代理, 统计的布局缓存不含其他用例留下的行
+    LeafButtonDelegate delegate;
+    std::unique_ptr<DynamicTreeView> view = createView(&model, false);
+    view->setItemDelegate(&delegate);
+    const QModelIndex childIndex = model.index(0, 0, model.index(0, 0));
+    view->collapse(childIndex);
+    delegate.setRevealedLeafCounts(&model, { qMakePair(QModelIndex(childIndex), leafCount) });
+    QImage image(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    view->viewport()->render(&image);
+
+    const int frames = 300;
+    const int step = leafCount * LeafStrip::ButtonPitch / frames;
+    QVector<qint64> frameNs;
+    frameNs.reserve(frames);
+
+    for (int frame = 0; frame < frames; ++frame) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!view->scrollLeafStrip(childIndex, step))
+            break;
+        view->viewport()->render(&image);
+        frameNs.append(timer.nsecsElapsed());
+    }
+    QVERIFY(!frameNs.isEmpty());
+    QVERIFY(delegate.stripOffset(childIndex) > 0);
+
+    MemoryReport report;
+    report.collectFrom(&delegate);
+    quint64 laidOutButtons = 0;
+    for (const MemoryReport::Entry &entry : report.entries()) {
+        if (entry.category == "leaf button layouts")
+            laidOutButtons = entry.objects;
+    }
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString("%1leafs").arg(leafCount);
+    m_report.recordValue(benchmark, tag, "frames", double(frameNs.size()));
+    recordFrameStats(benchmark, tag, frameNs);
+    m_report.recordValue(benchmark, tag, "laidOutButtons", double(laidOutButtons));
+    QVERIFY(laidOutButtons > 0);
+    QVERIFY(laidOutButtons <= quint64(view->visualRect(childIndex).width() / LeafStrip::ButtonPitch + 2));
+}
+
+void TreeBenchmarks::liveUpdates_data()
+{
+    QTest::addColumn<int>("nodeCount");
+    QTest::addColumn<bool>("coalesced");
+
+    for (const BenchSize &size : benchSizes()) {
+        QTest::newRow(QByteArray(size.tag).append("/direct").constData()) << size.nodes << false;
+        QTest::newRow(QByteArray(size.tag).append("/coalesced").constData()) << size.nodes << true;
+    }
+}
+
+void TreeBenchmarks::liveUpdates()
+{
+    QFETCH(int, nodeCount);
+    QFETCH(bool, coalesced);
+
+    // 数据源会修改模型, 每次使用新生成的树; 与应用相同使用 LeafTreeModel
+    std::unique_ptr<LeafTreeModel> model(new LeafTreeModel);
+    model->applySnapshot(buildSyntheticSnapshot(nodeCount));
+    std::unique_ptr<DynamicTreeView> view = createView(model.get(), false);
+
+    quint64 dataChangedSignals = 0;
+    QObject::connect(model.get(), &QAbstractItemModel::dataChanged, view.get(), [&dataChangedSignals] {
+        ++dataChangedSignals;
+    });
+
+    // direct: 每个更新单独排队到 GUI 线程调用 setData
+    quint64 directApplied = 0;
+    double directLatencySumMs = 0.0;
+    double directMaxLatencyMs = 0.0;
+
+    LiveUpdateQueue queue(model.get());
+    LeafTreeModel *target = model.get();
+    LiveFeedGenerator::Sink sink;
+    if (coalesced) {
+        sink = [&queue](quint64 nodeId, int role, const QVariant &value) { queue.post(nodeId, role, value); };
+    } else {
+        sink = [&](quint64 nodeId, int role, const QVariant &value) {
+            const quint64 postedNs = Perf::nowNs();
+            QMetaObject::invokeMethod(target, [&, nodeId, role, value, postedNs] {
+                target->setData(target->indexForId(nodeId), value, role);
+                const double latencyMs = (Perf::nowNs() - postedNs) / 1e6;
+                directLatencySumMs += latencyMs;
+                directMaxLatencyMs = qMax(directMaxLatencyMs, latencyMs);
+                ++directApplied;
+            }, Qt::QueuedConnection);
+        };
+    }
+
+    QVector<quint64> labelNodes;
+    QVector<quint64> checkNodes;
+    LiveFeedGenerator::collectTargets(model.get(), &labelNodes, &checkNodes);
+
+    // 4 个线程共以 50k/s 的速率产生 100k 个更新
+    const int updatesPerSecond = 50000;
+    const quint64 totalUpdates = 100000;
+    LiveFeedGenerator feed(sink);
+    feed.setTargets(labelNodes, checkNodes);
+
+    QElapsedTimer timer;
+    timer.start();
+    feed.start(updatesPerSecond, 4, totalUpdates);
+
+    auto drained = [&] {
+        if (coalesced) {
+            const LiveUpdateQueue::Stats stats = queue.stats();
+            return stats.applied + stats.merged + stats.unresolved >= totalUpdates;
+        }
+        return directApplied >= totalUpdates;
+    };
+    while (!drained() && timer.elapsed() < 60000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    const double elapsedSec = timer.nsecsElapsed() / 1e9;
+    feed.stop();
+    QVERIFY(drained());
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    m_report.recordValue(benchmark, tag, "updatesPerSecond", totalUpdates / elapsedSec);
+    m_report.recordValue(benchmark, tag, "dataChangedSignals", double(dataChangedSignals));
+    if (coalesced) {
+        const LiveUpdateQueue::Stats stats = queue.stats();
+        m_report.recordValue(benchmark, tag, "meanLatencyMs", stats.meanLatencyMs);
+        m_report.recordValue(benchmark, tag, "maxLatencyMs", stats.maxLatencyMs);
+        m_report.recordValue(benchmark, tag, "mergedUpdates", double(stats.merged));
+        m_report.recordValue(benchmark, tag, "frames", double(stats.frames));
+    } else {
+        m_report.recordValue(benchmark, tag, "meanLatencyMs", directLatencySumMs / directApplied);
+        m_report.recordValue(benchmark, tag, "maxLatencyMs", directMaxLatencyMs);
+    }
+}
+
+void TreeBenchmarks::restoreViewState()
+{
+    QFETCH(int, nodeCount);
+
+    // 展开所有根节点和子节点(约占节点总数的 11%), 并让部分子节点翻过页
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), true);
+    QAbstractItemModel *model = view->model();
+    QVector<QPair<QModelIndex, int>> paged;
+    for (int r = 0; r < model->rowCount(); r += 10)
+        paged.append(qMakePair(model->index(0, 0, model->index(r, 0)), 8));
+    m_delegate->setRevealedLeafCounts(model, paged);
+    view->scrollTo(model->index(model->rowCount() / 2, 0), QAbstractItemView::PositionAtTop);
+
+    QByteArray state;
+    TREE_BENCHMARK_ONCE(
+        state = TreeViewState::save(view.get());
+    );
+    QVERIFY(!state.isEmpty());
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    m_report.recordValue(benchmark, tag, "stateBytes", state.size());
+
+    // 从全部折叠开始恢复; indexBelow 会执行挂起的布局, 计入恢复耗时
+    view->collapseAll();
+    m_delegate->setRevealedLeafCounts(model, {});
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(TreeViewState::restore(view.get(), state));
+    view->indexBelow(model->index(0, 0));
+    m_report.recordValue(benchmark, tag, "restoreMs", timer.nsecsElapsed() / 1e6);
+
+    int expandedNodes = 0;
+    for (int r = 0; r < model->rowCount(); ++r) {
+        const QModelIndex root = model->index(r, 0);
+        expandedNodes += view->isExpanded(root) ? 1 : 0;
+        for (int c = 0; c < model->rowCount(root); ++c)
+            expandedNodes += view->isExpanded(model->index(c, 0, root)) ? 1 : 0;
+    }
+    m_report.recordValue(benchmark, tag, "expandedNodes", expandedNodes);
+    QCOMPARE(m_delegate->revealedLeafCount(paged.first().first), 8);
+    QCOMPARE(view->indexAt(QPoint(1, 1)), model->index(model->rowCount() / 2, 0));
+
+    m_delegate->setRevealedLeafCounts(model, {});
+}
+
+void TreeBenchmarks::sortProxy()
+{
+    QFETCH(int, nodeCount);
+
+    // 一个父节点下 nodeCount 个乱序叶节点, 是排序代理最坏的情况
+    QStandardItemModel model;
+    QStandardItem *parentItem = new QStandardItem("Child");
+    QList<QStandardItem *> leafs;
+    leafs.reserve(nodeCount);
+    QRandomGenerator random(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        leafs.append(new QStandardItem(QString("Leaf %1").arg(random.bounded(nodeCount))));
+    parentItem->appendRows(leafs);
+    model.appendRow(parentItem);
+
+    LeafSortProxyModel proxy;
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    QElapsedTimer timer;
+    timer.start();
+    proxy.setSourceModel(&model);
+    const QModelIndex proxyParent = proxy.index(0, 0);
+    QCOMPARE(proxy.rowCount(proxyParent), nodeCount);
+    m_report.recordValue(benchmark, tag, "initialSortMs", timer.nsecsElapsed() / 1e6);
+
+    // 逐个改名, 每次只做一次二分重新定位
+    const int renames = 1000;
+    TREE_BENCHMARK_ONCE(
+        for (int i = 0; i < renames; ++i)
+            leafs.at(random.bounded(nodeCount))->setText(QString("Leaf %1").arg(random.bounded(nodeCount)));
+    );
+
+    QCollator collator = proxy.collator();
+    for (int row = 1; row < qMin(nodeCount, 1000); ++row) {
+        QVERIFY(collator.compare(proxy.index(row - 1, 0, proxyParent).data().toString(),
+                                 proxy.index(row, 0, proxyParent).data().toString()) <= 0);
+    }
+
+    // 一个 dataChanged 覆盖多个相邻行(LiveUpdateQueue 合并出的范围), 这些行要一起重新定位:
+    // 10 20 30 40 50 中把第 2、3 行改为 7 和 5, 结果应为 5 7 10 40 50
+    LeafTreeModel rangeModel;
+    LeafTreeModel::Snapshot snapshot;
+    snapshot.nodes.append({ 1, 0, "Child", false, Qt::Unchecked });
+    for (int i = 1; i <= 5; ++i)
+        snapshot.nodes.append({ quint64(i + 1), 1, QString("Leaf %1").arg(i * 10), false, Qt::Unchecked });
+    rangeModel.applySnapshot(snapshot);
+    LeafSortProxyModel rangeProxy;
+    rangeProxy.setSourceModel(&rangeModel);
+    const QModelIndex rangeParent = rangeProxy.index(0, 0);
+    QCOMPARE(rangeProxy.rowCount(rangeParent), 5);
+
+    const LeafTreeModel::BatchStats batch = rangeModel.setDataBatch({ { 3, Qt::EditRole, QString("Leaf 7") },
+                                                                      { 4, Qt::EditRole, QString("Leaf 5") } });
+    QCOMPARE(batch.dataChangedSignals, 1);
+    QStringList order;
+    for (int row = 0; row < rangeProxy.rowCount(rangeParent); ++row)
+        order.append(rangeProxy.index(row, 0, rangeParent).data().toString());
+    QCOMPARE(order, QStringList({ "Leaf 5", "Leaf 7", "Leaf 10", "Leaf 40", "Leaf 50" }));
+
+    // 同样的情况放大: 在 nodeCount 个叶节点上反复改写随机的相邻行区间, 最后检查整个父节点有序
+    snapshot.nodes.resize(1);
+    for (int i = 0; i < nodeCount; ++i)
+        snapshot.nodes.append({ quint64(i + 2), 1, QString("Leaf %1").arg(random.bounded(nodeCount)), false,
+                                Qt::Unchecked });
+    rangeModel.applySnapshot(snapshot);
+    QCOMPARE(rangeProxy.rowCount(rangeParent), nodeCount);
+
+    const int rangeUpdates = 200;
+    timer.restart();
+    for (int i = 0; i < rangeUpdates; ++i) {
+        const int length = qMin(nodeCount, 2 + int(random.bounded(15)));
+        const int first = random.bounded(nodeCount - length + 1);
+        QVector<LeafTreeModel::DataUpdate> updates;
+        for (int row = first; row < first + length; ++row)
+            updates.append({ quint64(row + 2), Qt::EditRole, QString("Leaf %1").arg(random.bounded(nodeCount)) });
+        rangeModel.setDataBatch(updates);
+    }
+    m_report.recordValue(benchmark, tag, "rangeUpdateMs", timer.nsecsElapsed() / 1e6);
+
+    for (int row = 1; row < nodeCount; ++row) {
+        QVERIFY(collator.compare(rangeProxy.index(row - 1, 0, rangeParent).data().toString(),
+                                 rangeProxy.index(row, 0, rangeParent).data().toString()) <= 0);
+    }
+}
+
+void TreeBenchmarks::pathLookup()
+{
+    QFETCH(int, nodeCount);
+
+    QStandardItemModel *model = cachedModel(nodeCount);
+    PathIndex pathIndex(model);
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+
+    QElapsedTimer timer;
+    timer.start();
+    pathIndex.rebuild();
+    m_report.recordValue(benchmark, tag, "buildMs", timer.nsecsElapsed() / 1e6);
+    m_report.recordValue(benchmark, tag, "indexedParents", pathIndex.indexedParents());
+
+    // 预先生成随机叶节点的路径, 查找计时不包含路径拼接
+    QRandomGenerator random(nodeCount);
+    QStringList paths;
+    for (int i = 0; i < 10000; ++i) {
+        const QModelIndex root = model->index(random.bounded(model->rowCount()), 0);
+        const QModelIndex child = model->index(random.bounded(model->rowCount(root)), 0, root);
+        paths.append(PathIndex::pathFor(model->index(random.bounded(model->rowCount(child)), 0, child)));
+    }
+
+    int found = 0;
+    qint64 lookupNs = 0;
+    TREE_BENCHMARK_ONCE(
+        timer.restart();
+        for (const QString &path : std::as_const(paths))
+            found += pathIndex.find(path).isValid() ? 1 : 0;
+        lookupNs = timer.nsecsElapsed();
+    );
+    QCOMPARE(found, paths.size());
+    m_report.recordValue(benchmark, tag, "lookupsPerSecond", paths.size() / (qMax<qint64>(1, lookupNs) / 1e9));
+
+    // 改名后新路径立即可查, 旧路径失效
+    const QModelIndex target = pathIndex.find(paths.first());
+    QStandardItem *item = model->itemFromIndex(target);
+    const QString oldText = item->text();
+    item->setText(oldText + " (renamed)");
+    QCOMPARE(pathIndex.find(PathIndex::pathFor(target)), target);
+    QVERIFY(!pathIndex.find(paths.first()).isValid());
+    item->setText(oldText);
+
+    // 从折叠状态跳转: 展开祖先并滚动, scrollTo 会执行挂起的布局
+    std::unique_ptr<DynamicTreeView> view = createView(model, false);
+    view->collapseAll();
+    timer.restart();
+    QVERIFY(view->goToPath(paths.last()));
+    m_report.recordValue(benchmark, tag, "goToPathMs", timer.nsecsElapsed() / 1e6);
+    QCOMPARE(view->currentIndex(), pathIndex.find(paths.last()));
+    QVERIFY(view->isExpanded(view->currentIndex().parent()));
+}
+
+void TreeBenchmarks::memoryFootprint()
+{
+    QFETCH(int, nodeCount);
+
+    // 整棵展开并逐屏绘制, 让代理为每个子节点行建立布局缓存和持久索引
+    QStandardItemModel *model = cachedModel(nodeCount);
+    std::unique_ptr<DynamicTreeView> view = createView(model, true);
+    QImage frame(view->viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    const int frames = qMin(200, scrollBar->maximum() / qMax(1, scrollBar->pageStep()) + 1);
+    for (int i = 0; i < frames; ++i) {
+        scrollBar->setValue(i * scrollBar->pageStep());
+        view->viewport()->render(&frame);
+    }
+
+    MemoryReport report;
+    TREE_BENCHMARK_ONCE(
+        report = MemoryReport();
+        report.collectFrom(model);
+        report.collectFrom(m_delegate);
+    );
+    qDebug().noquote() << report.toText();
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    for (const MemoryReport::Entry &entry : report.entries()) {
+        QString metric = QString("%1_%2_bytes").arg(entry.subsystem, entry.category);
+        metric.replace(QRegularExpression("[^A-Za-z_]+"), "_");
+        m_report.recordValue(benchmark, tag, metric, double(entry.bytes));
+    }
+    m_report.recordValue(benchmark, tag, "modelBytesPerNode",
+                         double(report.subsystemBytes("QStandardItemModel")) / nodeCount);
+    m_report.recordValue(benchmark, tag, "delegateBytes",
+                         double(report.subsystemBytes("LeafButtonDelegate")));
+    m_report.recordValue(benchmark, tag, "totalBytes", double(report.totalBytes()));
+    QVERIFY(report.subsystemBytes("QStandardItemModel") > 0);
+}
+
+void TreeBenchmarks::snapshotApply()
+{
+    QFETCH(int, nodeCount);
+
+    const LeafTreeModel::Snapshot base = buildSyntheticSnapshot(nodeCount);
+    LeafTreeModel model;
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+
+    QElapsedTimer timer;
+    timer.start();
+    model.applySnapshot(base);
+    m_report.recordValue(benchmark, tag, "fullBuildMs", timer.nsecsElapsed() / 1e6);
+
+    // 约 1% 的节点变化, 改名、勾选、删除叶节点、新增叶节点和跨父节点移动各占五分之一
+    LeafTreeModel::Snapshot target = base;
+    QRandomGenerator random(nodeCount);
+    const int changes = qMax(10, int(base.nodes.size()) / 100);
+    quint64 nextId = quint64(base.nodes.size()) + 1;
+    QVector<bool> dropped(base.nodes.size(), false);
+    for (int c = 0; c < changes; ++c) {
+        const int position = random.bounded(int(base.nodes.size()));
+        LeafTreeModel::Snapshot::Node &node = target.nodes[position];
+        const bool isLeaf = node.text.startsWith("Leaf");
+        switch (c % 5) {
+        case 2:
+            if (isLeaf) {
+                dropped[position] = true;
+                break;
+            }
+            Q_FALLTHROUGH();
+        case 0:
+            node.text += " *";
+            break;
+        case 1:
+            node.checkable = true;
+            node.checkState = node.checkState == Qt::Checked ? Qt::Unchecked : Qt::Checked;
+            break;
+        case 3: {
+            LeafTreeModel::Snapshot::Node leaf;
+            leaf.id = nextId++;
+            leaf.parentId = isLeaf ? node.parentId : node.id;
+            leaf.text = QString("Leaf new %1").arg(leaf.id);
+            target.nodes.append(leaf);
+            break;
+        }
+        case 4: {
+            const LeafTreeModel::Snapshot::Node &other = base.nodes.at(random.bounded(int(base.nodes.size())));
+            if (isLeaf && other.text.startsWith("Leaf"))
+                node.parentId = other.parentId;
+            break;
+        }
+        }
+    }
+    LeafTreeModel::Snapshot filtered;
+    filtered.nodes.reserve(target.nodes.size());
+    for (int i = 0; i < target.nodes.size(); ++i) {
+        if (i >= dropped.size() || !dropped.at(i))
+            filtered.nodes.append(target.nodes.at(i));
+    }
+    target = filtered;
+
+    // 首个根节点不在变化范围内时, 其持久索引应当原样保留
+    const QPersistentModelIndex firstRoot = model.index(0, 0);
+    const QVariant firstRootId = firstRoot.data(NodeIdRole);
+
+    LeafTreeModel::ApplyStats stats;
+    TREE_BENCHMARK_ONCE(
+        stats = model.applySnapshot(target);
+    );
+    m_report.recordValue(benchmark, tag, "changedNodes", changes);
+    m_report.recordValue(benchmark, tag, "inserted", stats.inserted);
+    m_report.recordValue(benchmark, tag, "removed", stats.removed);
+    m_report.recordValue(benchmark, tag, "moved", stats.moved);
+    m_report.recordValue(benchmark, tag, "changed", stats.changed);
+    m_report.recordValue(benchmark, tag, "insertSignals", stats.insertSignals);
+    m_report.recordValue(benchmark, tag, "removeSignals", stats.removeSignals);
+    m_report.recordValue(benchmark, tag, "moveSignals", stats.moveSignals);
+    m_report.recordValue(benchmark, tag, "dataChangedSignals", stats.dataChangedSignals);
+
+    // 增量结果必须与从空模型一次建好的结果完全一致
+    LeafTreeModel fresh;
+    fresh.applySnapshot(target);
+    const LeafTreeModel::Snapshot actual = model.snapshot();
+    const LeafTreeModel::Snapshot expected = fresh.snapshot();
+    QCOMPARE(actual.nodes.size(), expected.nodes.size());
+    for (int i = 0; i < actual.nodes.size(); ++i) {
+        const LeafTreeModel::Snapshot::Node &a = actual.nodes.at(i);
+        const LeafTreeModel::Snapshot::Node &e = expected.nodes.at(i);
+        QCOMPARE(a.id, e.id);
+        QCOMPARE(a.parentId, e.parentId);
+        QCOMPARE(a.text, e.text);
+        QCOMPARE(a.checkState, e.checkState);
+    }
+    QVERIFY(firstRoot.isValid());
+    QCOMPARE(firstRoot.data(NodeIdRole), firstRootId);
+}
+
+void TreeBenchmarks::leafMove()
+{
+    QFETCH(int, nodeCount);
+
+    LeafTreeModel model;
+    model.applySnapshot(buildSyntheticSnapshot(nodeCount));
+    std::unique_ptr<DynamicTreeView> view = createView(&model, true);
+
+    // 从最后一个根节点之外的子节点中各取一段连续的叶节点(第 2~5 个), 放到最后一个根节点的第一个子节点开头
+    const QModelIndex target = model.index(0, 0, model.index(model.rowCount() - 1, 0));
+    QModelIndexList leafs;
+    int ranges = 0;
+    for (int r = 0; r < model.rowCount() - 1 && leafs.size() < 4096; ++r) {
+        const QModelIndex root = model.index(r, 0);
+        for (int c = 0; c < model.rowCount(root) && leafs.size() < 4096; ++c) {
+            const QModelIndex child = model.index(c, 0, root);
+            for (int l = 1; l < qMin(5, model.rowCount(child)); ++l)
+                leafs.append(model.index(l, 0, child));
+            ++ranges;
+        }
+    }
+    QVERIFY(!leafs.isEmpty());
+
+    QVector<quint64> ids;
+    QList<QPersistentModelIndex> persistent;
+    for (const QModelIndex &leaf : std::as_const(leafs)) {
+        ids.append(leaf.data(NodeIdRole).toULongLong());
+        persistent.append(leaf);
+    }
+
+    int calls = 0;
+    TREE_BENCHMARK_ONCE(
+        calls = LeafMove::moveLeafs(leafs, target, 0);
+    );
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    m_report.recordValue(benchmark, tag, "movedLeafs", leafs.size());
+    m_report.recordValue(benchmark, tag, "moveRowsCalls", calls);
+
+    // 每段连续的叶节点一次 moveRows; 节点按原有顺序排在开头, 持久索引随节点移动
+    QCOMPARE(calls, ranges);
+    for (int i = 0; i < ids.size(); ++i) {
+        QCOMPARE(model.index(i, 0, target).data(NodeIdRole).toULongLong(), ids.at(i));
+        QCOMPARE(persistent.at(i).parent(), target);
+        QCOMPARE(persistent.at(i).row(), i);
+    }
+
+    // 已在目标位置时不再移动
+    QModelIndexList moved;
+    for (const QPersistentModelIndex &leaf : std::as_const(persistent))
+        moved.append(leaf);
+    QCOMPARE(LeafMove::moveLeafs(moved, target, 0), 0);
+}
+
+SubtreeAggregates::Summary TreeBenchmarks::recursiveSummary(const QAbstractItemModel *model, const QModelIndex &index)
+{
+    // 按需递归统计, 即没有汇总层时每次悬停要做的事
+    SubtreeAggregates::Summary summary;
+    const int rowCount = model->rowCount(index);
+    if (index.isValid()) {
+        // 勾选状态在各层级都计入, 叶节点计数和数值只来自叶节点
+        summary.checked = index.data(Qt::CheckStateRole).toInt() == Qt::Checked ? 1 : 0;
+        if (rowCount == 0) {
+            summary.leafs = 1;
+            summary.sum = index.data(NodeValueRole).toDouble();
+        }
+    }
+    for (int row = 0; row < rowCount; ++row)
+        summary += recursiveSummary(model, model->index(row, 0, index));
+    return summary;
+}
+
+void TreeBenchmarks::subtreeAggregates()
+{
+    QFETCH(int, nodeCount);
+
+    // 新建模型, 给子节点加上复选状态, 给叶节点加上复选状态和数值, 此时还没有汇总层在监听
+    std::unique_ptr<QStandardItemModel> model(buildSyntheticTree(nodeCount));
+    QVector<QStandardItem *> children;
+    quint64 nextId = 1;
+    for (int r = 0; r < model->rowCount(); ++r) {
+        QStandardItem *root = model->item(r);
+        for (int c = 0; c < root->rowCount(); ++c) {
+            QStandardItem *child = root->child(c);
+            children.append(child);
+            child->setCheckable(true);
+            child->setCheckState(c % 2 == 0 ? Qt::Checked : Qt::Unchecked);
+            for (int l = 0; l < child->rowCount(); ++l) {
+                QStandardItem *leaf = child->child(l);
+                const quint64 id = leaf->data(NodeIdRole).toULongLong();
+                leaf->setCheckable(true);
+                leaf->setCheckState(id % 3 == 0 ? Qt::Checked : Qt::Unchecked);
+                leaf->setData(double(id % 10), NodeValueRole);
+                nextId = qMax(nextId, id + 1);
+            }
+        }
+    }
+    QVERIFY(!children.isEmpty());
+
+    SubtreeAggregates aggregates(model.get());
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    QElapsedTimer timer;
+    timer.start();
+    aggregates.rebuild();
+    m_report.recordValue(benchmark, tag, "buildMs", timer.nsecsElapsed() / 1e6);
+    m_report.recordValue(benchmark, tag, "indexedNodes", aggregates.indexedNodes());
+
+    // 整个模型的汇总: 递归统计与查表各一次
+    timer.restart();
+    const SubtreeAggregates::Summary recursive = recursiveSummary(model.get(), QModelIndex());
+    m_report.recordValue(benchmark, tag, "recursiveQueryMs", timer.nsecsElapsed() / 1e6);
+    timer.restart();
+    const SubtreeAggregates::Summary stored = aggregates.summary(QModelIndex());
+    m_report.recordValue(benchmark, tag, "lookupQueryUs", timer.nsecsElapsed() / 1e3);
+    QVERIFY(stored == recursive);
+
+    // 增量更新: 勾选叶节点或子节点本身、改数值、新增和删除叶节点, 每次只沿祖先链更新
+    QRandomGenerator random(nodeCount);
+    const int updates = 2000;
+    TREE_BENCHMARK_ONCE(
+        for (int i = 0; i < updates; ++i) {
+            QStandardItem *child = children.at(random.bounded(int(children.size())));
+            switch (i % 4) {
+            case 0:
+                if ((i / 4) % 2 == 1) {
+                    child->setCheckState(child->checkState() == Qt::Checked ? Qt::Unchecked : Qt::Checked);
+                } else if (child->rowCount() > 0) {
+                    QStandardItem *leaf = child->child(random.bounded(child->rowCount()));
+                    leaf->setCheckState(leaf->checkState() == Qt::Checked ? Qt::Unchecked : Qt::Checked);
+                }
+                break;
+            case 1:
+                if (child->rowCount() > 0)
+                    child->child(random.bounded(child->rowCount()))->setData(double(random.bounded(100)), NodeValueRole);
+                break;
+            case 2: {
+                QStandardItem *leaf = new QStandardItem(QString("Leaf new %1").arg(nextId));
+                leaf->setData(QVariant::fromValue<quint64>(nextId++), NodeIdRole);
+                leaf->setCheckable(true);
+                leaf->setCheckState(Qt::Checked);
+                leaf->setData(1.0, NodeValueRole);
+                child->appendRow(leaf);
+                break;
+            }
+            case 3:
+                if (child->rowCount() > 0)
+                    child->removeRow(random.bounded(child->rowCount()));
+                break;
+            }
+        }
+    );
+
+    // 增量结果必须与重新递归统计的结果一致
+    QVERIFY(aggregates.summary(QModelIndex()) == recursiveSummary(model.get(), QModelIndex()));
+    for (int i = 0; i < 100; ++i) {
+        const QModelIndex child = children.at(random.bounded(int(children.size())))->index();
+        QVERIFY(aggregates.summary(child) == recursiveSummary(model.get(), child));
+        QVERIFY(aggregates.summary(child.parent()) == recursiveSummary(model.get(), child.parent()));
+    }
+}
+
+void TreeBenchmarks::sessionReplay()
+{
+    QFETCH(int, nodeCount);
+
+    // 录制一段点击行与键盘导航的交互(不打开模态对话框), 经二进制格式往返后
+    // 在同样初始状态的新视图上尽快回放, 记录每类动作的延迟分位数
+    std::unique_ptr<DynamicTreeView> view = createView(cachedModel(nodeCount), false);
+    // 点在行的最左侧, 不会落在叶节点按钮上(点击按钮会打开模态的详情对话框)
+    const int rowHeight = qMax(1, view->sizeHintForRow(0));
+    SessionRecorder recorder(view.get());
+    recorder.start();
+    for (int i = 0; i < 50; ++i) {
+        QTest::mouseClick(view->viewport(), Qt::LeftButton, Qt::NoModifier,
+                          QPoint(2, (i % 10) * rowHeight + rowHeight / 2));
+        QTest::keyClick(view.get(), Qt::Key_Down);
+        QTest::keyClick(view.get(), Qt::Key_Right);
+        QTest::keyClick(view.get(), Qt::Key_Escape);
+    }
+    recorder.stop();
+    view.reset();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(recorder.session().write(&buffer));
+    buffer.seek(0);
+    InteractionSession session;
+    QVERIFY(session.read(&buffer));
+    QCOMPARE(session.events.size(), recorder.session().events.size());
+    QVERIFY(session.events.size() >= 50 * 8);
+
+    std::unique_ptr<DynamicTreeView> replayView = createView(cachedModel(nodeCount), false);
+    SessionReplayer replayer(replayView.get(), session);
+    replayer.setRecordedTiming(false);
+    QSignalSpy finished(&replayer, &SessionReplayer::finished);
+    TREE_BENCHMARK_ONCE(
+        replayer.start();
+        if (!replayer.isFinished())
+            finished.wait(60000);
+    );
+    QVERIFY(replayer.isFinished());
+    QCOMPARE(replayer.replayedEvents(), session.events.size());
+    QCOMPARE(replayer.skippedEvents(), 0);
+
+    const QString benchmark = QString::fromLatin1(QTest::currentTestFunction());
+    const QString tag = QString::fromLatin1(QTest::currentDataTag());
+    m_report.recordValue(benchmark, tag, "sessionBytes", double(buffer.size()));
+    m_report.recordValue(benchmark, tag, "bytesPerEvent", double(buffer.size()) / session.events.size());
+    for (const SessionReplayer::ActionStats &stats : replayer.stats()) {
+        const QString action = QString(stats.action).replace(' ', '_');
+        m_report.recordValue(benchmark, tag, action + "_p50Ms", stats.p50Ms);
+        m_report.recordValue(benchmark, tag, action + "_p95Ms", stats.p95Ms);
+        m_report.recordValue(benchmark, tag, action + "_maxMs", stats.maxMs);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认无头运行, 可通过 -platform 或 QT_QPA_PLATFORM 覆盖
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    TreeBenchmarks benchmarks;
+    QTEST_SET_MAIN_SOURCE_PATH
+    return QTest::qExec(&benchmarks, argc, argv);
+}
+
+#include "tst_treebenchmarks.moc"
@@ -0,0 +1,64 @@
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = sessionreplay
+
+# 回放对象是 QTreeView 的主窗口, 直接编译上级工程的源文件; 报告格式沿用基准测试的 BenchReport
+INCLUDEPATH += ../.. ../benchmarks ../../../common
+
+perf_counters: DEFINES += LEAFTREE_PERF_COUNTERS
+
+SOURCES += \
+    ../../leafbuttonaccessible.cpp \
+    ../../leafbuttondelegate.cpp \
+    ../../leafmove.cpp \
+    ../../leafsortproxymodel.cpp \
+    ../../leaftreemodel.cpp \
+    ../../leafstrip.cpp \
+    ../../livefeedgenerator.cpp \
+    ../../liveupdatequeue.cpp \
+    ../../mainwindow.cpp \
+    ../../memoryreport.cpp \
+    ../../modelprofiler.cpp \
+    ../../pathindex.cpp \
+    ../../perfcounters.cpp \
+    ../../perfoverlay.cpp \
+    ../../rowtilerenderer.cpp \
+    ../../sessionrecorder.cpp \
+    ../../sessionreplayer.cpp \
+    ../../subtreeaggregates.cpp \
+    ../../treeviewstate.cpp \
+    ../benchmarks/benchreport.cpp \
+    sessionreplay.cpp
+
+HEADERS += \
+    ../../aligndelegate.h \
+    ../../dynamictreeview.h \
+    ../../leafbuttonaccessible.h \
+    ../../leafbuttondelegate.h \
+    ../../leafmove.h \
+    ../../leafsortproxymodel.h \
+    ../../leaftreemodel.h \
+    ../../leafstrip.h \
+    ../../livefeedgenerator.h \
+    ../../liveupdatequeue.h \
+    ../../mainwindow.h \
+    ../../memoryreport.h \
+    ../../modelprofiler.h \
+    ../../pathindex.h \
+    ../../mpscqueue.h \
+    ../../perfcounters.h \
+    ../../perfoverlay.h \
+    ../../rowtilerenderer.h \
+    ../../sessionrecorder.h \
+    ../../sessionreplayer.h \
+    ../../subtreeaggregates.h \
+    ../../summarydelegate.h \
+    ../../treeroles.h \
+    ../../treeviewstate.h \
+    ../../../common/startupprofiler.h \
+    ../benchmarks/benchreport.h
@@ -0,0 +1,83 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTest>
+#include <QTextStream>
+
+#include "mainwindow.h"
+#include "sessionrecorder.h"
+#include "sessionreplayer.h"
+#include "benchreport.h"
+
+// 无头回放 LEAFTREE_RECORD_SESSION 录制的交互, 输出每类动作的延迟分位数;
+// 同一段录制在不同构建上回放, 对比的是完全相同的操作序列
+int main(int argc, char *argv[])
+{
+    // 默认无头运行, 可通过 -platform 或 QT_QPA_PLATFORM 覆盖
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    // 与录制时一样从全部展开开始, 不读写用户保存的视图状态
+    qputenv("LEAFTREE_NO_VIEW_STATE", "1");
+    qunsetenv("LEAFTREE_RECORD_SESSION");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a session recorded with LEAFTREE_RECORD_SESSION against the tree "
+                                     "window and reports per-action latency percentiles.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("session", "Session file to replay.");
+    const QCommandLineOption nodesOption("nodes", "Generate a tree with about <count> nodes.", "count");
+    const QCommandLineOption fastOption("fast", "Send each event as soon as the previous one is handled "
+                                                "instead of keeping the recorded timing.");
+    const QCommandLineOption reportOption("report", "Base name of the CSV/JSON report.", "name", "session_replay");
+    parser.addOptions({ nodesOption, fastOption, reportOption });
+    parser.process(app);
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1)
+        parser.showHelp(1);
+
+    InteractionSession session;
+    if (!session.load(positional.first())) {
+        qCritical().noquote() << "Cannot read session" << positional.first();
+        return 1;
+    }
+
+    // MainWindow::setupModel 按该变量生成更大的树, 前面的行与录制时相同
+    if (parser.isSet(nodesOption))
+        qputenv("LEAFTREE_GENERATED_NODES", parser.value(nodesOption).toLatin1());
+
+    MainWindow window;
+    window.show();
+    // 对话框以活动窗口为父窗口, 先激活主窗口, 对话框才会落在录制时的控件路径上
+    window.activateWindow();
+    if (!QTest::qWaitForWindowActive(&window))
+        qWarning() << "Window was not activated";
+
+    SessionReplayer replayer(&window, session);
+    replayer.setRecordedTiming(!parser.isSet(fastOption));
+    QObject::connect(&replayer, &SessionReplayer::finished, &app, &QCoreApplication::quit);
+    replayer.start();
+    if (!replayer.isFinished())
+        app.exec();
+
+    QTextStream(stdout) << replayer.summary() << '\n';
+
+    BenchReport report;
+    const QString tag = parser.isSet(nodesOption) ? parser.value(nodesOption) : QString("default");
+    for (const SessionReplayer::ActionStats &stats : replayer.stats()) {
+        report.recordValue(stats.action, tag, "count", stats.count);
+        report.recordValue(stats.action, tag, "p50Ms", stats.p50Ms);
+        report.recordValue(stats.action, tag, "p95Ms", stats.p95Ms);
+        report.recordValue(stats.action, tag, "p99Ms", stats.p99Ms);
+        report.recordValue(stats.action, tag, "maxMs", stats.maxMs);
+    }
+    report.recordValue("session", tag, "replayedEvents", replayer.replayedEvents());
+    report.recordValue("session", tag, "skippedEvents", replayer.skippedEvents());
+    report.recordValue("session", tag, "elapsedMs", double(replayer.elapsedMs()));
+    if (!report.write(parser.value(reportOption))) {
+        qWarning() << "Failed to write replay report";
+        return 1;
+    }
+    return 0;
+}
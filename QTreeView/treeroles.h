@@ -0,0 +1,16 @@
+#ifndef TREEROLES_H
+#define TREEROLES_H
+
+#include <Qt>
+
+// 树模型的自定义角色
+enum TreeRole {
+    // 节点的稳定 ID (quint64), 在整个模型内唯一, 行号变化后保持不变
+    NodeIdRole = Qt::UserRole + 1,
+    // 叶节点的数值 (double), 子树汇总时求和
+    NodeValueRole = Qt::UserRole + 2,
+    // 节点是否有子节点 (bool), 与 hasChildren() 一致; 供视图与其他角色一起批量取回
+    HasChildrenRole = Qt::UserRole + 3
+};
+
+#endif // TREEROLES_H
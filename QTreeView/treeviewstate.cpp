@@ -0,0 +1,208 @@
+#include "treeviewstate.h"
+#include "dynamictreeview.h"
+#include "leafbuttondelegate.h"
+#include "treeroles.h"
+#include <QDataStream>
+#include <QMap>
+#include <QScrollBar>
+#include <QSet>
+#include <algorithm>
+
+namespace TreeViewState {
+
+namespace {
+
+const quint32 STATE_MAGIC = 0x4c545653; // "LTVS"
+const quint8 STATE_VERSION = 2;
+
+struct NodeSets {
+    QSet<quint64> expanded;           // 节点已展开
+    QMap<quint64, qint32> paged;      // 节点的"..."翻过页 -> 已显示的子节点数
+    QSet<quint64> descend;            // 子树中有需要恢复的节点, 恢复时需要进入
+    quint64 topNodeId = 0;
+    qint32 verticalValue = 0;
+    qint32 horizontalValue = 0;
+};
+
+quint64 nodeId(const QModelIndex &index)
+{
+    return index.data(NodeIdRole).toULongLong();
+}
+
+// 升序 ID 写成与前一个的差值, 相近的 ID 压缩后只占很少的字节
+void writeIds(QDataStream &out, QVector<quint64> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    out << quint32(ids.size());
+    quint64 previous = 0;
+    for (quint64 id : std::as_const(ids)) {
+        out << quint64(id - previous);
+        previous = id;
+    }
+}
+
+QVector<quint64> readIds(QDataStream &in)
+{
+    quint32 count = 0;
+    in >> count;
+    QVector<quint64> ids;
+    quint64 id = 0;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        quint64 delta = 0;
+        in >> delta;
+        id += delta;
+        ids.append(id);
+    }
+    return ids;
+}
+
+// 沿父链标记祖先; 遇到已标记的祖先即可停止, 它之上的节点已经标记过
+void markAncestors(NodeSets &sets, const QModelIndex &index)
+{
+    for (QModelIndex parent = index.parent(); parent.isValid(); parent = parent.parent()) {
+        const quint64 id = nodeId(parent);
+        if (sets.descend.contains(id))
+            break;
+        sets.descend.insert(id);
+    }
+}
+
+void collectExpanded(const DynamicTreeView *view, const QModelIndex &parent, NodeSets &sets)
+{
+    const QAbstractItemModel *model = view->model();
+    const int rows = model->rowCount(parent);
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        if (!model->hasChildren(index))
+            continue;
+        if (view->isExpanded(index)) {
+            sets.expanded.insert(nodeId(index));
+            markAncestors(sets, index);
+        }
+        collectExpanded(view, index, sets);
+    }
+}
+
+struct RestoreTargets {
+    QModelIndexList expand;
+    QVector<QPair<QModelIndex, int>> paged;
+    QModelIndex top;
+};
+
+void collectTargets(const QAbstractItemModel *model, const QModelIndex &parent, const NodeSets &sets,
+                    RestoreTargets &targets)
+{
+    const int rows = model->rowCount(parent);
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        const QVariant idValue = index.data(NodeIdRole);
+        if (!idValue.isValid())
+            continue;
+
+        const quint64 id = idValue.toULongLong();
+        if (sets.expanded.contains(id))
+            targets.expand.append(index);
+        const auto paged = sets.paged.constFind(id);
+        if (paged != sets.paged.constEnd())
+            targets.paged.append(qMakePair(index, int(paged.value())));
+        if (id == sets.topNodeId)
+            targets.top = index;
+        if (sets.descend.contains(id))
+            collectTargets(model, index, sets, targets);
+    }
+}
+
+} // namespace
+
+QByteArray save(const DynamicTreeView *view)
+{
+    const QAbstractItemModel *model = view->model();
+    if (!model)
+        return QByteArray();
+
+    NodeSets sets;
+    collectExpanded(view, QModelIndex(), sets);
+
+    if (const LeafButtonDelegate *delegate = qobject_cast<const LeafButtonDelegate *>(view->itemDelegate())) {
+        for (const QModelIndex &parent : delegate->pagedParents(model)) {
+            sets.paged.insert(nodeId(parent), delegate->revealedLeafCount(parent));
+            markAncestors(sets, parent);
+        }
+    }
+
+    const QModelIndex top = view->indexAt(QPoint(1, 1));
+    if (top.isValid()) {
+        sets.topNodeId = nodeId(top);
+        markAncestors(sets, top);
+    }
+    sets.verticalValue = view->verticalScrollBar()->value();
+    sets.horizontalValue = view->horizontalScrollBar()->value();
+
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_15);
+        writeIds(out, sets.expanded.values().toVector());
+        // 分页状态按节点 ID 升序保存, 与 QMap 的顺序一致
+        writeIds(out, sets.paged.keys().toVector());
+        out << sets.paged.values().toVector();
+        writeIds(out, sets.descend.values().toVector());
+        out << sets.topNodeId << sets.verticalValue << sets.horizontalValue;
+    }
+
+    QByteArray state;
+    QDataStream out(&state, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << STATE_MAGIC << STATE_VERSION << qCompress(payload);
+    return state;
+}
+
+bool restore(DynamicTreeView *view, const QByteArray &state)
+{
+    QAbstractItemModel *model = view->model();
+    if (!model || state.isEmpty())
+        return false;
+
+    quint32 magic = 0;
+    quint8 version = 0;
+    QByteArray compressed;
+    QDataStream in(state);
+    in.setVersion(QDataStream::Qt_5_15);
+    in >> magic >> version >> compressed;
+    if (in.status() != QDataStream::Ok || magic != STATE_MAGIC || version != STATE_VERSION)
+        return false;
+
+    NodeSets sets;
+    QDataStream payload(qUncompress(compressed));
+    payload.setVersion(QDataStream::Qt_5_15);
+    for (quint64 id : readIds(payload))
+        sets.expanded.insert(id);
+    const QVector<quint64> pagedIds = readIds(payload);
+    QVector<qint32> revealedCounts;
+    payload >> revealedCounts;
+    for (quint64 id : readIds(payload))
+        sets.descend.insert(id);
+    payload >> sets.topNodeId >> sets.verticalValue >> sets.horizontalValue;
+    if (payload.status() != QDataStream::Ok || revealedCounts.size() != pagedIds.size())
+        return false;
+    for (int i = 0; i < pagedIds.size(); ++i)
+        sets.paged.insert(pagedIds.at(i), revealedCounts.at(i));
+
+    // 只进入 descend 标记的子树, 不遍历整棵树
+    RestoreTargets targets;
+    collectTargets(model, QModelIndex(), sets, targets);
+
+    view->setExpandedBulk(targets.expand);
+
+    if (LeafButtonDelegate *delegate = qobject_cast<LeafButtonDelegate *>(view->itemDelegate()))
+        delegate->setRevealedLeafCounts(model, targets.paged);
+
+    if (targets.top.isValid())
+        view->scrollTo(targets.top, QAbstractItemView::PositionAtTop);
+    else
+        view->verticalScrollBar()->setValue(sets.verticalValue);
+    view->horizontalScrollBar()->setValue(sets.horizontalValue);
+    return true;
+}
+
+} // namespace TreeViewState
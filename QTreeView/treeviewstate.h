@@ -0,0 +1,19 @@
+#ifndef TREEVIEWSTATE_H
+#define TREEVIEWSTATE_H
+
+#include <QByteArray>
+
+class DynamicTreeView;
+
+// 树视图状态的保存与恢复: 展开的节点、"..."分页和滚动位置
+// 节点按 NodeIdRole 标识, 展开与分页状态保存为升序节点 ID 的差分序列, 整体再做 zlib 压缩;
+// ID 可以是任意 64 位值, 状态大小只与标记的节点数有关.
+// 恢复时只遍历标记到的子树, 并通过 DynamicTreeView::setExpandedBulk 一次完成布局
+namespace TreeViewState {
+
+QByteArray save(const DynamicTreeView *view);
+bool restore(DynamicTreeView *view, const QByteArray &state);
+
+} // namespace TreeViewState
+
+#endif // TREEVIEWSTATE_H
@@ -0,0 +1,137 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+#include <functional>
+
+// 启动阶段计时: main() 开头调用 start(), 之后在各阶段结束处 mark(),
+// 程序退出时输出各阶段相对 start() 的时间点.
+// 只头文件实现, QTreeView 与 Dialog 两个工程共用
+// STARTUP_PROFILE=1 时退出前打印到调试输出, STARTUP_PROFILE_JSON=<文件> 时另写出 JSON
+namespace StartupProfiler {
+
+struct Phase {
+    QString name;
+    double ms = 0.0;
+};
+
+inline QElapsedTimer &timer()
+{
+    static QElapsedTimer elapsed;
+    return elapsed;
+}
+
+inline QVector<Phase> &phases()
+{
+    static QVector<Phase> recorded;
+    return recorded;
+}
+
+inline void mark(const QString &phase)
+{
+    if (timer().isValid())
+        phases().append({ phase, timer().nsecsElapsed() / 1e6 });
+}
+
+inline QByteArray toJson()
+{
+    QJsonArray array;
+    for (const Phase &phase : std::as_const(phases())) {
+        QJsonObject object;
+        object["phase"] = phase.name;
+        object["ms"] = phase.ms;
+        array.append(object);
+    }
+    return QJsonDocument(array).toJson();
+}
+
+inline void report()
+{
+    if (qEnvironmentVariableIsSet("STARTUP_PROFILE")) {
+        double previous = 0.0;
+        for (const Phase &phase : std::as_const(phases())) {
+            qDebug().noquote() << QString("startup %1 %2 ms (+%3 ms)")
+                                  .arg(phase.name, -24)
+                                  .arg(phase.ms, 8, 'f', 1)
+                                  .arg(phase.ms - previous, 0, 'f', 1);
+            previous = phase.ms;
+        }
+    }
+
+    const QString jsonPath = qEnvironmentVariable("STARTUP_PROFILE_JSON");
+    if (!jsonPath.isEmpty()) {
+        QFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(toJson()) < 0)
+            qWarning() << "Failed to write startup profile to" << jsonPath;
+    }
+}
+
+// 在构造 QApplication 之前调用
+inline void start()
+{
+    timer().start();
+    phases().clear();
+}
+
+// 在 QApplication 构造之后调用: 记录该阶段并在退出时输出报告
+inline void applicationCreated()
+{
+    mark("QApplication init");
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, qApp, []{ report(); });
+}
+
+// widget 第一次绘制完成后(回到事件循环时)调用一次 callback.
+// 只由 Paint 事件触发: widget 一直隐藏或最小化(例如以最小化方式启动)时不会回调,
+// 报告中也就没有对应的阶段; watcher 随 widget 一起销毁
+class FirstPaintWatcher : public QObject
+{
+public:
+    FirstPaintWatcher(QWidget *widget, std::function<void()> callback)
+        : QObject(widget), m_callback(std::move(callback))
+    {
+        widget->installEventFilter(this);
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            watched->removeEventFilter(this);
+            // 绘制事件处理完、本帧送出之后再执行
+            QTimer::singleShot(0, this, [this]{
+                m_callback();
+                deleteLater();
+            });
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    std::function<void()> m_callback;
+};
+
+inline void afterFirstPaint(QWidget *widget, std::function<void()> callback)
+{
+    new FirstPaintWatcher(widget, std::move(callback));
+}
+
+// 第一次绘制完成时记录 phase; 从未绘制过时不记录
+inline void markFirstPaint(QWidget *widget, const QString &phase = QStringLiteral("first paint"))
+{
+    afterFirstPaint(widget, [phase]{ mark(phase); });
+}
+
+} // namespace StartupProfiler
+
+#endif // STARTUPPROFILER_H